@@ -0,0 +1,48 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/batch_executor.hpp"
+#include "malbolge/loader.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <iterator>
+
+using namespace malbolge;
+
+namespace
+{
+// The loader logs at INFO level, which would swamp the benchmark output
+const auto quiet_logging = []() {
+    log::set_log_level(log::ERROR);
+    return true;
+}();
+
+void batch_executor_run(benchmark::State& state)
+{
+    auto stream = std::ifstream{"programs/hello_world.mal", std::ios::binary};
+    const auto source = std::string{std::istreambuf_iterator<char>{stream},
+                                    std::istreambuf_iterator<char>{}};
+
+    auto executor = batch_executor{};
+    const auto batch_size = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto jobs = std::vector<batch_executor::job>{};
+        jobs.reserve(batch_size);
+        for (auto i = 0u; i < batch_size; ++i) {
+            auto data = source;
+            jobs.push_back({load(data, load_normalised_mode::OFF), ""});
+        }
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(executor.run(std::move(jobs)));
+    }
+    state.SetItemsProcessed(state.iterations() * batch_size);
+}
+}
+
+BENCHMARK(batch_executor_run)->Arg(1024)->Unit(benchmark::kMillisecond)->UseRealTime();
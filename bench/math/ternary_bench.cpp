@@ -0,0 +1,68 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/math/ternary.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+using namespace malbolge;
+
+namespace
+{
+std::vector<math::ternary> random_ternaries(std::size_t size)
+{
+    // Fixed seed so runs are comparable
+    auto gen = std::mt19937{42};
+    auto dist = std::uniform_int_distribution<math::ternary::underlying_type>{
+        0,
+        math::ternary::max
+    };
+
+    auto result = std::vector<math::ternary>{};
+    result.reserve(size);
+    for (auto i = 0u; i < size; ++i) {
+        result.emplace_back(dist(gen));
+    }
+
+    return result;
+}
+
+template <math::ternary::backend B>
+void ternary_op(benchmark::State& state)
+{
+    const auto data = random_ternaries(4096);
+
+    auto i = std::size_t{0};
+    for (auto _ : state) {
+        const auto& a = data[i % data.size()];
+        const auto& b = data[(i + 1) % data.size()];
+        benchmark::DoNotOptimize(a.op<B>(b));
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <math::ternary::backend B>
+void ternary_rotate(benchmark::State& state)
+{
+    const auto data = random_ternaries(4096);
+
+    auto i = std::size_t{0};
+    for (auto _ : state) {
+        auto a = data[i % data.size()];
+        benchmark::DoNotOptimize(a.rotate<B>());
+        ++i;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+}
+
+BENCHMARK_TEMPLATE(ternary_op, math::ternary::backend::TRITWISE);
+BENCHMARK_TEMPLATE(ternary_op, math::ternary::backend::TABLE);
+BENCHMARK_TEMPLATE(ternary_rotate, math::ternary::backend::TRITWISE);
+BENCHMARK_TEMPLATE(ternary_rotate, math::ternary::backend::TABLE);
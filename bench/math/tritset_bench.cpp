@@ -0,0 +1,62 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/math/ternary.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+using namespace malbolge;
+
+namespace
+{
+using tritset_type = math::ternary::tritset_type;
+
+std::vector<std::uint32_t> random_values(std::size_t size)
+{
+    // Fixed seed so runs are comparable
+    auto gen = std::mt19937{42};
+    auto dist = std::uniform_int_distribution<std::uint32_t>{0, tritset_type::max};
+
+    auto result = std::vector<std::uint32_t>(size);
+    for (auto& v : result) {
+        v = dist(gen);
+    }
+
+    return result;
+}
+
+void tritset_construction(benchmark::State& state)
+{
+    const auto data = random_values(4096);
+
+    auto i = std::size_t{0};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tritset_type{data[i++ % data.size()]});
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void tritset_to_base10(benchmark::State& state)
+{
+    const auto values = random_values(4096);
+    auto data = std::vector<tritset_type>{};
+    data.reserve(values.size());
+    for (auto v : values) {
+        data.emplace_back(v);
+    }
+
+    auto i = std::size_t{0};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(data[i++ % data.size()].to_base10());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+}
+
+BENCHMARK(tritset_construction);
+BENCHMARK(tritset_to_base10);
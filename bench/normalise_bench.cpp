@@ -0,0 +1,115 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/normalise.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+
+using namespace malbolge;
+
+namespace
+{
+// Random normalised program, with a fixed seed so runs are comparable
+std::string random_normalised_program(std::size_t size)
+{
+    auto gen = std::mt19937{42};
+    auto dist = std::uniform_int_distribution<std::size_t>{
+        0,
+        cpu_instruction::all.size() - 1
+    };
+
+    auto program = std::string(size, '\0');
+    for (auto& c : program) {
+        c = cpu_instruction::all[dist(gen)];
+    }
+    return program;
+}
+
+// Sets the SIMD level from the second benchmark argument for the lifetime of
+// the instance
+class scoped_simd_level
+{
+public:
+    explicit scoped_simd_level(const benchmark::State& state) :
+        prev_{detail::active_simd_level()}
+    {
+        const auto level = static_cast<detail::simd_level>(state.range(1));
+        detail::set_simd_level(level);
+        if (detail::active_simd_level() != level) {
+            unsupported_ = true;
+        }
+    }
+
+    ~scoped_simd_level()
+    {
+        detail::set_simd_level(prev_);
+    }
+
+    bool unsupported() const noexcept
+    {
+        return unsupported_;
+    }
+
+private:
+    detail::simd_level prev_;
+    bool unsupported_ = false;
+};
+
+void normalise(benchmark::State& state)
+{
+    const auto level = scoped_simd_level{state};
+    if (level.unsupported()) {
+        state.SkipWithError("SIMD level not supported");
+        return;
+    }
+
+    auto source = random_normalised_program(state.range(0));
+    denormalise_source(source);
+
+    for (auto _ : state) {
+        auto data = source;
+        benchmark::DoNotOptimize(normalise_source(data));
+    }
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+
+void denormalise(benchmark::State& state)
+{
+    const auto level = scoped_simd_level{state};
+    if (level.unsupported()) {
+        state.SkipWithError("SIMD level not supported");
+        return;
+    }
+
+    const auto source = random_normalised_program(state.range(0));
+    for (auto _ : state) {
+        auto data = source;
+        benchmark::DoNotOptimize(denormalise_source(data));
+    }
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+
+void is_likely_normalised(benchmark::State& state)
+{
+    const auto level = scoped_simd_level{state};
+    if (level.unsupported()) {
+        state.SkipWithError("SIMD level not supported");
+        return;
+    }
+
+    const auto source = random_normalised_program(state.range(0));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(is_likely_normalised_source(source));
+    }
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+}
+
+BENCHMARK(normalise)->ArgsProduct({{59000}, {0, 1, 2}})->Unit(benchmark::kMicrosecond);
+BENCHMARK(denormalise)->ArgsProduct({{59000}, {0, 1, 2}})->Unit(benchmark::kMicrosecond);
+BENCHMARK(is_likely_normalised)->ArgsProduct({{59000}, {0, 1, 2}})->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,28 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/utility/signal.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace malbolge;
+
+namespace
+{
+void signal_emit(benchmark::State& state)
+{
+    auto sig = utility::signal<char>{};
+    for (auto i = 0; i < state.range(0); ++i) {
+        sig.connect([](char c) { benchmark::DoNotOptimize(c); });
+    }
+
+    for (auto _ : state) {
+        sig('a');
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+}
+
+BENCHMARK(signal_emit)->Arg(0)->Arg(1)->Arg(4);
@@ -0,0 +1,161 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/execute.hpp"
+#include "malbolge/virtual_cpu.hpp"
+#include "malbolge/loader.hpp"
+#include "malbolge/normalise.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <condition_variable>
+#include <fstream>
+#include <iterator>
+
+using namespace malbolge;
+
+namespace
+{
+// The loader logs at INFO level, which would swamp the benchmark output
+const auto quiet_logging = []() {
+    log::set_log_level(log::ERROR);
+    return true;
+}();
+
+std::string read_program(const std::filesystem::path& path)
+{
+    auto stream = std::ifstream{path, std::ios::binary};
+    return {std::istreambuf_iterator<char>{stream},
+            std::istreambuf_iterator<char>{}};
+}
+
+// A program that fills the memory space, and runs straight through it before
+// stopping on the last cell.  Rotate and op write to D, which would corrupt the
+// code ahead of C, so only data pointer moves, writes, and nops are used
+virtual_memory long_program()
+{
+    constexpr auto pattern = std::string_view{"joo<jo<oo<j<o"};
+
+    auto program = std::string(math::ternary::max + 1, cpu_instruction::nop);
+    for (auto i = 0u; i < program.size(); ++i) {
+        program[i] = pattern[i % pattern.size()];
+    }
+    program.back() = cpu_instruction::stop;
+
+    return load(program, load_normalised_mode::ON);
+}
+
+// Runs the program until it stops or waits for input that is never coming
+void run_program(virtual_memory vmem,
+                 const std::string& input,
+                 virtual_cpu::engine_type engine = virtual_cpu::engine_type::STANDARD,
+                 bool buffered_output = false)
+{
+    auto vcpu = virtual_cpu{std::move(vmem)};
+    vcpu.set_engine(engine);
+    auto mtx = std::mutex{};
+    auto cv = std::condition_variable{};
+    auto finished = false;
+
+    vcpu.register_for_state_signal([&](auto state, auto) {
+        if (state == virtual_cpu::execution_state::STOPPED ||
+            state == virtual_cpu::execution_state::WAITING_FOR_INPUT) {
+            {
+                auto lk = std::lock_guard{mtx};
+                finished = true;
+            }
+            cv.notify_one();
+        }
+    });
+    if (buffered_output) {
+        vcpu.register_for_buffered_output_signal([](auto str) {
+            benchmark::DoNotOptimize(str);
+        });
+    } else {
+        vcpu.register_for_output_signal([](auto c) {
+            benchmark::DoNotOptimize(c);
+        });
+    }
+
+    if (!input.empty()) {
+        vcpu.add_input(input);
+    }
+    vcpu.run();
+
+    auto lk = std::unique_lock{mtx};
+    cv.wait(lk, [&]() { return finished; });
+}
+
+void run_program(benchmark::State& state, const char* path, const char* input)
+{
+    const auto source = read_program(path);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto data = source;
+        auto vmem = load(data, load_normalised_mode::OFF);
+        state.ResumeTiming();
+
+        run_program(std::move(vmem), input);
+    }
+}
+
+void run_long_program(benchmark::State& state, virtual_cpu::engine_type engine)
+{
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto vmem = long_program();
+        state.ResumeTiming();
+
+        run_program(std::move(vmem), "", engine, true);
+    }
+    state.SetItemsProcessed(state.iterations() * math::ternary::max);
+}
+
+// As run_long_program(), but each run uses a clone of the same memory image
+void run_cloned_long_program(benchmark::State& state, virtual_cpu::engine_type engine)
+{
+    auto base = long_program();
+    for (auto _ : state) {
+        run_program(base.clone(), "", engine, true);
+    }
+    state.SetItemsProcessed(state.iterations() * math::ternary::max);
+}
+
+void execute_program(benchmark::State& state, const char* path, const char* input)
+{
+    const auto source = read_program(path);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto data = source;
+        auto vmem = load(data, load_normalised_mode::OFF);
+        state.ResumeTiming();
+
+        const auto result = execute(std::move(vmem), input, [](char c) {
+            benchmark::DoNotOptimize(c);
+        });
+        benchmark::DoNotOptimize(result);
+    }
+}
+}
+
+BENCHMARK_CAPTURE(run_program, hello_world, "programs/hello_world.mal", "")
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(run_program, echo, "programs/echo.mal", "Hello World!\n")
+    ->Unit(benchmark::kMicrosecond);
+
+// The program runs on the vCPU's thread, so CPU time is meaningless here
+BENCHMARK_CAPTURE(run_long_program, standard, virtual_cpu::engine_type::STANDARD)
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK_CAPTURE(run_long_program, threaded, virtual_cpu::engine_type::THREADED)
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK_CAPTURE(run_long_program, fused, virtual_cpu::engine_type::FUSED)
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+BENCHMARK_CAPTURE(run_cloned_long_program, fused, virtual_cpu::engine_type::FUSED)
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+BENCHMARK_CAPTURE(execute_program, hello_world, "programs/hello_world.mal", "")
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK_CAPTURE(execute_program, echo, "programs/echo.mal", "Hello World!\n")
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,125 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/virtual_memory.hpp"
+#include "malbolge/loader.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+using namespace malbolge;
+
+namespace
+{
+// The loader logs at INFO level, which would swamp the benchmark output
+const auto quiet_logging = []() {
+    log::set_log_level(log::ERROR);
+    return true;
+}();
+
+void virtual_memory_construction(benchmark::State& state)
+{
+    // Cycle through every graphical ASCII ending so that nothing can be
+    // specialised for a single program
+    auto program = std::vector<char>(state.range(0), 'a');
+    auto i = 0u;
+    for (auto _ : state) {
+        program.back() = static_cast<char>(graphical_ascii_range.first +
+                                           (i++ % cipher::size));
+        benchmark::DoNotOptimize(virtual_memory(program));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void load_program(benchmark::State& state,
+                  const char* path,
+                  load_normalised_mode mode)
+{
+    auto stream = std::ifstream{path, std::ios::binary};
+    const auto source = std::string{std::istreambuf_iterator<char>{stream},
+                                    std::istreambuf_iterator<char>{}};
+
+    for (auto _ : state) {
+        auto data = source;
+        benchmark::DoNotOptimize(load(data, mode));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// A large, machine-generated style program: denormalised nops wrapped at 80
+// columns
+std::string wrapped_program(std::size_t size)
+{
+    auto program = std::string(size, 'o');
+    denormalise_source(program);
+    auto source = std::string{};
+    for (auto i = 0u; i < program.size(); ++i) {
+        if (i && (i % 80) == 0) {
+            source.push_back('\n');
+        }
+        source.push_back(program[i]);
+    }
+
+    return source;
+}
+
+void load_wrapped_program(benchmark::State& state)
+{
+    const auto source = wrapped_program(state.range(0));
+    for (auto _ : state) {
+        auto data = source;
+        benchmark::DoNotOptimize(load(data, load_normalised_mode::OFF));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+
+void load_wrapped_program_file(benchmark::State& state)
+{
+    const auto source = wrapped_program(state.range(0));
+    const auto path = std::filesystem::temp_directory_path() /
+                      "malbolge_bench_wrapped.mal";
+    {
+        auto stream = std::ofstream{path, std::ios::binary | std::ios::trunc};
+        stream << source;
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(load(path, load_normalised_mode::OFF));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * source.size());
+
+    std::filesystem::remove(path);
+}
+
+void load_wrapped_program_stream(benchmark::State& state)
+{
+    const auto source = wrapped_program(state.range(0));
+    for (auto _ : state) {
+        auto stream = std::istringstream{source};
+        benchmark::DoNotOptimize(load_from_stream(stream, load_normalised_mode::AUTO));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * source.size());
+}
+}
+
+BENCHMARK(virtual_memory_construction)->Arg(2)->Arg(128)->Arg(8192);
+BENCHMARK_CAPTURE(load_program, hello_world,
+                  "programs/hello_world.mal", load_normalised_mode::OFF);
+BENCHMARK_CAPTURE(load_program, echo,
+                  "programs/echo.mal", load_normalised_mode::OFF);
+BENCHMARK_CAPTURE(load_program, hello_world_normalised,
+                  "programs/hello_world_normalised.mal", load_normalised_mode::ON);
+BENCHMARK(load_wrapped_program)->Arg(1024)->Arg(59000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(load_wrapped_program_file)->Arg(1024)->Arg(59000)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(load_wrapped_program_stream)->Arg(1024)->Arg(59000)
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,60 @@
+# Copyright Cam Mannett 2020
+#
+# See LICENSE file
+#
+
+find_package(benchmark QUIET)
+if(NOT benchmark_FOUND)
+    message(STATUS "Google Benchmark not found, malbolge_bench unavailable")
+    return()
+endif()
+
+set(BENCH_SRCS
+    ${CMAKE_CURRENT_SOURCE_DIR}/batch_executor_bench.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/math/ternary_bench.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/math/tritset_bench.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/normalise_bench.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/utility/signal_bench.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/virtual_cpu_bench.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/virtual_memory_bench.cpp
+)
+
+add_executable(malbolge_bench EXCLUDE_FROM_ALL ${BENCH_SRCS})
+add_dependencies(malbolge_bench gen_version malbolge_lib)
+
+target_compile_features(malbolge_bench PUBLIC cxx_std_20)
+set_target_properties(malbolge_bench PROPERTIES CXX_EXTENSIONS OFF)
+
+target_compile_options(malbolge_bench PRIVATE
+    $<$<OR:$<CXX_COMPILER_ID:Clang>,$<CXX_COMPILER_ID:AppleClang>,$<CXX_COMPILER_ID:GNU>>:
+        -Werror -Wall -Wextra>
+    $<$<CXX_COMPILER_ID:MSVC>:
+        /W4>
+)
+
+target_include_directories(malbolge_bench
+    PUBLIC ${CMAKE_CURRENT_SOURCE_DIR}/../include
+    PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}
+)
+
+target_link_libraries(malbolge_bench
+    PUBLIC benchmark::benchmark_main
+    PUBLIC Threads::Threads
+    PUBLIC malbolge_lib
+)
+
+message(STATUS "Copying over example programs for benchmarks")
+file(COPY ${CMAKE_CURRENT_SOURCE_DIR}/../test/programs
+     DESTINATION ${CMAKE_CURRENT_BINARY_DIR})
+
+# Runs the full suite and writes the results as JSON, for comparing against a
+# baseline (e.g. with Google Benchmark's tools/compare.py)
+add_custom_target(malbolge_bench_json
+    COMMAND malbolge_bench
+            --benchmark_out=${CMAKE_CURRENT_BINARY_DIR}/malbolge_bench.json
+            --benchmark_out_format=json
+    WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}
+    DEPENDS malbolge_bench
+    COMMENT "Running benchmarks, results in ${CMAKE_CURRENT_BINARY_DIR}/malbolge_bench.json"
+    USES_TERMINAL
+)
@@ -16,10 +16,13 @@ set(TEST_SRCS
     ${CMAKE_CURRENT_SOURCE_DIR}/algorithm/container_ops_test.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/algorithm/remove_from_range_test.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/algorithm/trim_test.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/batch_executor_test.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/c_interface_test.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/corpus_test.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/cpu_instruction_test.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/debugger/script_parser_test.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/debugger/script_runner_test.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/execute_test.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/loader_test.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/log_test.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/main_test.cpp
@@ -37,6 +40,7 @@ set(TEST_SRCS
     ${CMAKE_CURRENT_SOURCE_DIR}/utility/string_view_ops_test.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/utility/tuple_iterator_test.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/utility/unescaper_test.cpp
+    ${CMAKE_CURRENT_SOURCE_DIR}/vcpu_snapshot_test.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/virtual_memory_test.cpp
     ${CMAKE_CURRENT_SOURCE_DIR}/virtual_cpu_test.cpp
 )
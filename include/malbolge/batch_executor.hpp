@@ -0,0 +1,100 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#pragma once
+
+#include "malbolge/execution_limits.hpp"
+#include "malbolge/virtual_cpu.hpp"
+
+#include <vector>
+
+namespace malbolge
+{
+/** Executes many independent programs across a fixed-size thread pool.
+ *
+ * Unlike virtual_cpu, no thread or event loop is created per program.  Each
+ * program is interpreted to completion on one of the pool's worker threads,
+ * with idle workers stealing queued programs from busy ones.
+ *
+ * This class can not be copied or moved.
+ */
+class batch_executor
+{
+public:
+    /** A program to execute.
+     */
+    struct job
+    {
+        virtual_memory vmem;            ///< Initialised memory space
+        std::string input;              ///< Program input, followed by EOF
+        execution_limits limits = {};   ///< Execution limits
+    };
+
+    /** The result of executing a job.
+     */
+    struct result
+    {
+        /** Collected program output.
+         */
+        std::string output;
+
+        /** Final execution state.
+         *
+         * This is either virtual_cpu::execution_state::STOPPED, or
+         * virtual_cpu::execution_state::WAITING_FOR_INPUT if the program
+         * requested more input after the job's input (and EOF) was consumed.
+         */
+        virtual_cpu::execution_state state = virtual_cpu::execution_state::READY;
+
+        /** Exception pointer, null if no error.
+         *
+         * In case of an error the execution state is always STOPPED.  If one
+         * of the job's limits was reached, then this is a limit_exception.
+         */
+        std::exception_ptr error;
+
+        /** Number of instructions executed.
+         */
+        std::size_t steps = 0;
+    };
+
+    /** Constructor.
+     *
+     * @param num_threads Number of worker threads, if zero then
+     * <TT>std::thread::hardware_concurrency()</TT> is used
+     */
+    explicit batch_executor(std::size_t num_threads = 0);
+
+    /** Destructor.
+     *
+     * Blocks until the worker threads have finished their current jobs.
+     */
+    ~batch_executor();
+
+    batch_executor(const batch_executor&) = delete;
+    batch_executor& operator=(const batch_executor&) = delete;
+
+    /** Returns the number of worker threads.
+     *
+     * @return Worker thread count
+     */
+    [[nodiscard]]
+    std::size_t size() const noexcept;
+
+    /** Executes @a jobs and blocks until they have all finished.
+     *
+     * Programs that never stop or request input will never finish, so set
+     * job::limits for untrusted programs.  Concurrent calls are serialised.
+     * @param jobs Programs to execute
+     * @return Results, in the same order as @a jobs
+     */
+    [[nodiscard]]
+    std::vector<result> run(std::vector<job> jobs);
+
+private:
+    class impl_t;
+    std::unique_ptr<impl_t> impl_;
+};
+}
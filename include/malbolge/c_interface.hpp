@@ -38,6 +38,9 @@ enum malbolge_result
     MALBOLGE_ERR_NULL_ARG               = -0x1002, ///< An input was unexpectedly NULL
     MALBOLGE_ERR_PARSE_FAIL             = -0x1003, ///< Program source parse failure
     MALBOLGE_ERR_EXECUTION_FAIL         = -0x1004, ///< Program execution failure
+    MALBOLGE_ERR_STEP_LIMIT             = -0x1005, ///< vCPU instruction limit reached
+    MALBOLGE_ERR_DEADLINE               = -0x1006, ///< vCPU runtime limit reached
+    MALBOLGE_ERR_OUTPUT_LIMIT           = -0x1007, ///< vCPU output limit reached
 };
 
 /** vCPU execution states.
@@ -347,6 +350,31 @@ int malbolge_vcpu_pause(malbolge_virtual_cpu vcpu);
  */
 int malbolge_vcpu_step(malbolge_virtual_cpu vcpu);
 
+/** Asynchronously sets the execution limits of @a vcpu.
+ *
+ * When a limit is reached the vCPU is stopped, and the state callbacks are
+ * called with MALBOLGE_VCPU_STOPPED and one of MALBOLGE_ERR_STEP_LIMIT,
+ * MALBOLGE_ERR_DEADLINE, or MALBOLGE_ERR_OUTPUT_LIMIT.  Any previously set
+ * limits are replaced.
+ *
+ * This is equivalent to virtual_cpu::set_limits(execution_limits).
+ * @param vcpu vCPU handle returned from
+ * malbolge_create_vcpu(malbolge_virtual_memory)
+ * @param max_steps Maximum number of instructions to execute, or 0 for no
+ * limit
+ * @param max_runtime_ms Number of milliseconds from this call until the vCPU
+ * is stopped, or 0 for no limit
+ * @param max_output Maximum number of characters to output, or 0 for no limit
+ * @return
+ * - MALBOLGE_ERR_SUCCESS for success
+ * - MALBOLGE_ERR_NULL_ARG if @a vcpu is NULL
+ * - MALBOLGE_ERR_UNKNOWN if an unknown failure occurs
+ */
+int malbolge_vcpu_set_limits(malbolge_virtual_cpu vcpu,
+                             unsigned int max_steps,
+                             unsigned int max_runtime_ms,
+                             unsigned int max_output);
+
 /** Asynchronsouly passes @a buffer to @a vcpu to use as user input.
  *
  * @a buffer is copied into the vCPU, so this can be called before @a vcpu is
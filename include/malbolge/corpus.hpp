@@ -0,0 +1,77 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#pragma once
+
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace malbolge
+{
+/** Operation to apply to each file in a corpus.
+ */
+enum class corpus_operation {
+    VALIDATE,       ///< Check the program loads, nothing is written
+    NORMALISE,      ///< Normalise the program
+    DENORMALISE,    ///< Denormalise the program
+    NUM_OPERATIONS  ///< Number of operations
+};
+
+/** Textual streaming operator for corpus_operation.
+ *
+ * @param stream Output stream
+ * @param op Instance to stream
+ * @return @a stream
+ */
+std::ostream& operator<<(std::ostream& stream, corpus_operation op);
+
+/** The result of processing a single corpus file.
+ */
+struct corpus_file_result
+{
+    /** Input file path.
+     */
+    std::filesystem::path path;
+
+    /** Exception pointer, null if no error.
+     */
+    std::exception_ptr error;
+
+    /** Time taken to read, process, and write the file.
+     */
+    std::chrono::nanoseconds duration{0};
+};
+
+/** Applies @a op to every <TT>.mal</TT> file found (recursively) under
+ * @a dirs, in parallel.
+ *
+ * Each file's result is written to @a output_dir, at the same path relative to
+ * the input directory it was found in.  If more than one input directory is
+ * given then their trees are merged in @a output_dir, files that would be
+ * written to the same output path are not processed and have an error in
+ * their results instead.
+ *
+ * An error in one file does not stop the others from being processed, it is
+ * recorded in that file's result instead.
+ * @param dirs Input directories
+ * @param op Operation to apply
+ * @param output_dir Output directory, created if it does not exist.  Ignored
+ * (and may be empty) for corpus_operation::VALIDATE
+ * @param num_threads Number of worker threads, if zero then
+ * <TT>std::thread::hardware_concurrency()</TT> is used
+ * @return Per-file results, sorted by path
+ * @exception system_exception Thrown if an input directory cannot be iterated,
+ * or if @a output_dir is missing for an operation that writes
+ */
+[[nodiscard]]
+std::vector<corpus_file_result>
+process_corpus(const std::vector<std::filesystem::path>& dirs,
+               corpus_operation op,
+               const std::optional<std::filesystem::path>& output_dir = {},
+               std::size_t num_threads = 0);
+}
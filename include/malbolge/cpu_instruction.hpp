@@ -7,7 +7,9 @@
 
 #include <array>
 #include <algorithm>
+#include <cstdint>
 #include <optional>
+#include <ostream>
 
 namespace malbolge
 {
@@ -74,6 +76,46 @@ constexpr auto all = std::array{
     stop,
     nop
 };
+
+/** Compact instruction opcode enumeration.
+ *
+ * This is the result of decoding a pre-ciphered program value, the
+ * instructions are in the same order as cpu_instruction::all so one can be
+ * converted to the other via to_type(opcode).
+ */
+enum class opcode : std::uint8_t
+{
+    set_data_ptr,   ///< cpu_instruction::set_data_ptr
+    set_code_ptr,   ///< cpu_instruction::set_code_ptr
+    rotate,         ///< cpu_instruction::rotate
+    op,             ///< cpu_instruction::op
+    read,           ///< cpu_instruction::read
+    write,          ///< cpu_instruction::write
+    stop,           ///< cpu_instruction::stop
+    nop,            ///< cpu_instruction::nop
+    unknown,        ///< Graphical ASCII, but not an instruction.  A nop during
+                    ///< execution, but an error during program load
+    invalid         ///< Not graphical ASCII, always an error
+};
+
+/** Converts @a code to its instruction character.
+ *
+ * @param code Opcode, must not be opcode::unknown or opcode::invalid
+ * @return Instruction
+ */
+[[nodiscard]]
+constexpr type to_type(opcode code) noexcept
+{
+    return all[static_cast<std::size_t>(code)];
+}
+
+/** Textual streaming operator.
+ *
+ * @param stream Output stream
+ * @param code Opcode
+ * @return @a stream
+ */
+std::ostream& operator<<(std::ostream& stream, opcode code);
 }
 
 /** True if @a instruction is a valid Malbolge CPU instruction.
@@ -137,6 +179,42 @@ std::optional<char> pre(std::size_t index) noexcept;
  */
 [[nodiscard]]
 std::optional<char> post(std::size_t index) noexcept;
+
+/** Pre-cipher decode table.
+ *
+ * Indexed by <TT>[input - graphical_ascii_range.first][index % size]</TT>,
+ * where @em input is a graphical ASCII character and @em index is its position
+ * in the program data.
+ */
+extern const std::array<std::array<cpu_instruction::opcode, size>, size> pre_table;
+
+/** Post-cipher encode table.
+ *
+ * Indexed by <TT>input - graphical_ascii_range.first</TT>, where @em input is
+ * a graphical ASCII character.
+ */
+extern const std::array<char, size> post_table;
+
+/** Sentinel value returned by post_cipher_encode(T) for non-graphical ASCII
+ * input.
+ */
+constexpr auto invalid = char{0};
+
+/** The result of executing a program value.
+ */
+struct transition
+{
+    cpu_instruction::opcode instr;  ///< Decoded (pre-ciphered) instruction
+    char encrypted;                 ///< Post-ciphered replacement value
+};
+
+/** Fused pre- and post-cipher table.
+ *
+ * Indexed the same as pre_table, each entry combines the pre_table and
+ * post_table lookups so an executed value can be decoded and its replacement
+ * found in a single load.
+ */
+extern const std::array<std::array<transition, size>, size> transition_table;
 }
 
 /** Performs a pre-instruction cipher on @a input.
@@ -177,4 +255,82 @@ std::optional<char> post_cipher_instruction(T input) noexcept
     input -= graphical_ascii_range.first;
     return cipher::post(static_cast<std::size_t>(input));
 }
+
+/** Pre-ciphers @a input and decodes it into an instruction opcode.
+ *
+ * This is a table lookup equivalent of pre_cipher_instruction(T, std::size_t)
+ * followed by an instruction check, and is used on the hot path of the vCPU,
+ * loader, and normaliser.
+ * @tparam T Input character type, must be explicitly convertible to
+ * std::size_t
+ * @param input Input character
+ * @param index Index of the character in the program data
+ * @return Decoded opcode, cpu_instruction::opcode::invalid if @a input is not
+ * within the graphical ASCII range
+ */
+template <typename T>
+[[nodiscard]]
+cpu_instruction::opcode pre_cipher_decode(T input, std::size_t index) noexcept
+{
+    // Non-graphical values (including negative chars) wrap to out of range
+    const auto i = static_cast<std::size_t>(input) -
+                   static_cast<std::size_t>(graphical_ascii_range.first);
+    if (i >= cipher::size) [[unlikely]] {
+        return cpu_instruction::opcode::invalid;
+    }
+
+    return cipher::pre_table[i][index % cipher::size];
+}
+
+/** Decodes @a input into an instruction opcode, and post-ciphers it.
+ *
+ * This is equivalent to pre_cipher_decode(T, std::size_t) and
+ * post_cipher_encode(T) in a single table lookup.  Unlike
+ * pre_cipher_decode(T, std::size_t), @a index_mod must already be reduced
+ * modulo cipher::size, as callers iterating through memory can track that far
+ * more cheaply than a division per call.
+ * @tparam T Input character type, must be explicitly convertible to
+ * std::size_t
+ * @param input Input character
+ * @param index_mod Index of the character in the program data, modulo
+ * cipher::size
+ * @return Decoded opcode and post-ciphered value, or
+ * <TT>{cpu_instruction::opcode::invalid, cipher::invalid}</TT> if @a input is
+ * not within the graphical ASCII range
+ */
+template <typename T>
+[[nodiscard]]
+cipher::transition cipher_transition(T input, std::size_t index_mod) noexcept
+{
+    const auto i = static_cast<std::size_t>(input) -
+                   static_cast<std::size_t>(graphical_ascii_range.first);
+    if (i >= cipher::size) [[unlikely]] {
+        return {cpu_instruction::opcode::invalid, cipher::invalid};
+    }
+
+    return cipher::transition_table[i][index_mod];
+}
+
+/** Post-ciphers @a input.
+ *
+ * This is a table lookup equivalent of post_cipher_instruction(T) that uses a
+ * sentinel rather than an optional.
+ * @tparam T Input character type, must be explicitly convertible to
+ * std::size_t
+ * @param input Input character
+ * @return The ciphered value, or cipher::invalid if @a input is not within the
+ * graphical ASCII range
+ */
+template <typename T>
+[[nodiscard]]
+char post_cipher_encode(T input) noexcept
+{
+    const auto i = static_cast<std::size_t>(input) -
+                   static_cast<std::size_t>(graphical_ascii_range.first);
+    if (i >= cipher::size) [[unlikely]] {
+        return cipher::invalid;
+    }
+
+    return cipher::post_table[i];
+}
 }
@@ -302,7 +302,8 @@ using remove_breakpoint = function<
  * Once this is called in the sequence, subsequent functions are called once a
  * breakpoint hits.  The optional max_runtime argument puts an upperbound on
  * how long the program can run (in milliseconds) without  a breakpoint being
- * hit.  The timeout will trigger virtual_cpu::stop() being called.
+ * hit.  The timeout is applied as an execution_limits::deadline,
+ * and ends the script as if the program had stopped.
  */
 using run = function<
     MAL_STR(run),
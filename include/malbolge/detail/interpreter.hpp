@@ -0,0 +1,485 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#pragma once
+
+#include "malbolge/cpu_instruction.hpp"
+#include "malbolge/exception.hpp"
+#include "malbolge/log.hpp"
+#include "malbolge/virtual_memory.hpp"
+
+#include <optional>
+#include <utility>
+
+/** Defined if interpreter::run(std::size_t, InputFn&&, OutputFn&&, YieldFn&&)
+ * dispatches using computed goto (the GCC/Clang labels-as-values extension),
+ * rather than a switch.
+ *
+ * Define MALBOLGE_NO_COMPUTED_GOTO to force the switch implementation.
+ */
+#if defined(__GNUC__) && !defined(MALBOLGE_NO_COMPUTED_GOTO)
+#define MALBOLGE_COMPUTED_GOTO
+#endif
+
+namespace malbolge
+{
+/** Namespace for implementation details.
+ *
+ * Types in here are not part of the stable API.
+ */
+namespace detail
+{
+/** Malbolge instruction interpreter.
+ *
+ * This holds the vCPU registers and memory, and executes instructions on the
+ * calling thread.  It has no knowledge of threading, breakpoints, or signals;
+ * virtual_cpu and batch_executor build on top of it.
+ */
+class interpreter
+{
+public:
+    /** Result of a step(InputFn&&, OutputFn&&) call.
+     */
+    enum class step_result {
+        CONTINUE,           ///< Instruction executed, can continue onto the next
+        WAITING_FOR_INPUT,  ///< Input is required, nothing was executed
+        STOPPED             ///< Stop instruction executed
+    };
+
+    /** Constructor.
+     *
+     * @param vm Virtual memory containing the initialised memory space
+     * (including program data)
+     */
+    explicit interpreter(virtual_memory vm) noexcept :
+        vmem(std::move(vm)),
+        c{0},
+        d{0},
+        p_counter{0}
+    {}
+
+    /** Executes the instruction at the code pointer.
+     *
+     * @a input is called when the read instruction is executed, it must return
+     * the value to load into the accumulator, or an empty optional if there is
+     * no input available.  In the latter case the instruction is not executed
+     * and step_result::WAITING_FOR_INPUT is returned.
+     *
+     * @a output is called with the character to write when the write
+     * instruction is executed.
+     * @tparam InputFn Input function type, with the signature
+     * <TT>std::optional<math::ternary> ()</TT>
+     * @tparam OutputFn Output function type, with the signature
+     * <TT>void (char)</TT>
+     * @param input Input function
+     * @param output Output function
+     * @return Step result
+     * @exception execution_exception Thrown if the pre- or post-cipher input is
+     * not graphical ASCII
+     */
+    template <typename InputFn, typename OutputFn>
+    step_result step(InputFn&& input, OutputFn&& output)
+    {
+        // Only take mutable references when writing, as that may copy a shared
+        // memory page
+        const auto& cvmem = vmem;
+        const auto c_value = cvmem.unchecked_at(c);
+        const auto d_value = cvmem.unchecked_at(d);
+
+        // Pre-cipher the instruction
+        const auto instr = pre_cipher_decode(c_value, c);
+        if (instr == cpu_instruction::opcode::invalid) [[unlikely]] {
+            throw execution_exception{
+                "Pre-cipher non-whitespace character must be graphical "
+                    "ASCII: " + std::to_string(static_cast<int>(c_value)),
+                p_counter
+            };
+        }
+
+        log::print_lazy<log::VERBOSE_DEBUG>([&]() {
+            return std::tuple{"Step: ", p_counter, ", pre-cipher instr: ", instr};
+        });
+
+        switch (instr) {
+        case cpu_instruction::opcode::set_data_ptr:
+            d = static_cast<virtual_memory::size_type>(d_value);
+            break;
+        case cpu_instruction::opcode::set_code_ptr:
+            c = static_cast<virtual_memory::size_type>(d_value);
+            break;
+        case cpu_instruction::opcode::rotate:
+            a = vmem.unchecked_at(d).rotate();
+            break;
+        case cpu_instruction::opcode::op:
+            a = vmem.unchecked_at(d) = a.op(d_value);
+            break;
+        case cpu_instruction::opcode::read:
+        {
+            const auto value = input();
+            if (!value) {
+                log::print<log::VERBOSE_DEBUG>("\tWaiting for input...");
+                return step_result::WAITING_FOR_INPUT;
+            }
+            a = *value;
+            break;
+        }
+        case cpu_instruction::opcode::write:
+            if (a != math::ternary::max) {
+                output(static_cast<char>(a));
+            }
+            break;
+        case cpu_instruction::opcode::stop:
+            return step_result::STOPPED;
+        default:
+            // Nop
+            break;
+        }
+
+        // Post-cipher the instruction.  The jump instruction may have moved
+        // the code pointer, so c_value cannot be used here
+        auto& c_post = vmem.unchecked_at(c);
+        const auto pc = post_cipher_encode(c_post);
+        if (pc == cipher::invalid) [[unlikely]] {
+            throw execution_exception{
+                "Post-cipher non-whitespace character must be graphical "
+                    "ASCII: " + std::to_string(static_cast<int>(c_post)),
+                p_counter
+            };
+        }
+        c_post = pc;
+
+        log::print_lazy<log::VERBOSE_DEBUG>([&]() {
+            return std::tuple{"\tPost-op regs - a: ", a,
+                              ", c[", c, "]: ", c_post,
+                              ", d[", d, "]: ", cvmem.unchecked_at(d)};
+        });
+
+        increment(c);
+        increment(d);
+        ++p_counter;
+        return step_result::CONTINUE;
+    }
+
+    /** Executes up to @a max_steps instructions.
+     *
+     * This is equivalent to calling step(InputFn&&, OutputFn&&) in a loop, but
+     * the registers are held in locals for the duration of the call, and the
+     * instructions are dispatched directly from one to the next (using
+     * computed goto when available) instead of through a single switch.  The
+     * registers are written back on return, including by exception.  There is
+     * no per-instruction logging.
+     *
+     * @a yield is called after every executed instruction, if it returns true
+     * then the run ends and step_result::CONTINUE is returned.
+     *
+     * If @a Fused is true, each instruction is decoded and its post-cipher
+     * replacement found with a single cipher_transition(T, std::size_t)
+     * lookup, and C modulo the cipher size is tracked incrementally rather
+     * than calculated for every instruction.
+     *
+     * If the memory image is not shared with a clone, it is accessed directly
+     * for the whole run rather than through the page lookup.
+     * @tparam Fused True to use the fused cipher transition table
+     * @tparam InputFn Input function type, with the signature
+     * <TT>std::optional<math::ternary> ()</TT>
+     * @tparam OutputFn Output function type, with the signature
+     * <TT>void (char)</TT>
+     * @tparam YieldFn Yield function type, with the signature
+     * <TT>bool ()</TT>
+     * @param max_steps Maximum number of instructions to execute
+     * @param input Input function
+     * @param output Output function
+     * @param yield Yield function
+     * @return step_result::CONTINUE if @a max_steps was reached or @a yield
+     * returned true, otherwise the result of the last instruction
+     * @exception execution_exception Thrown if the pre- or post-cipher input is
+     * not graphical ASCII
+     */
+    template <bool Fused = false,
+              typename InputFn,
+              typename OutputFn,
+              typename YieldFn>
+    step_result run(std::size_t max_steps,
+                    InputFn&& input,
+                    OutputFn&& output,
+                    YieldFn&& yield)
+    {
+        if (!max_steps) {
+            return step_result::CONTINUE;
+        }
+
+        if (const auto flat = vmem.flat_data()) {
+            return run_impl<Fused>(flat_access{flat}, max_steps, input, output, yield);
+        }
+        return run_impl<Fused>(paged_access{vmem}, max_steps, input, output, yield);
+    }
+
+    virtual_memory vmem;    ///< Virtual memory
+
+    math::ternary a;                ///< Accumulator register
+    virtual_memory::size_type c;    ///< Code pointer register
+    virtual_memory::size_type d;    ///< Data pointer register
+    std::size_t p_counter;          ///< Number of instructions executed
+
+private:
+    // Memory accessors for run_impl(..), the flat one skips the page lookup
+    // and so can only be used whilst the memory image is private
+    struct flat_access
+    {
+        virtual_memory::pointer mem;
+
+        virtual_memory::const_reference read(virtual_memory::size_type pos) const noexcept
+        {
+            return mem[pos];
+        }
+
+        virtual_memory::reference write(virtual_memory::size_type pos) const noexcept
+        {
+            return mem[pos];
+        }
+    };
+
+    struct paged_access
+    {
+        virtual_memory& vmem;
+
+        virtual_memory::const_reference read(virtual_memory::size_type pos) const noexcept
+        {
+            return std::as_const(vmem).unchecked_at(pos);
+        }
+
+        virtual_memory::reference write(virtual_memory::size_type pos) const
+        {
+            return vmem.unchecked_at(pos);
+        }
+    };
+
+    template <bool Fused,
+              typename Memory,
+              typename InputFn,
+              typename OutputFn,
+              typename YieldFn>
+    step_result run_impl(Memory mem,
+                         std::size_t max_steps,
+                         InputFn& input,
+                         OutputFn& output,
+                         YieldFn& yield)
+    {
+        // The registers must not escape (e.g. by being captured in a type-erased
+        // scope guard), otherwise they cannot be kept in CPU registers across
+        // the input/output calls
+        auto reg_a = a;
+        auto reg_c = c;
+        auto reg_d = d;
+        auto steps = std::size_t{0};
+        auto finish = [&](step_result result) {
+            a = reg_a;
+            c = reg_c;
+            d = reg_d;
+            p_counter += steps;
+            return result;
+        };
+
+        // Only used when fused: C modulo the cipher size, and the post-ciphered
+        // value of the instruction at C
+        auto c_mod = Fused ? reg_c % cipher::size : 0;
+        auto encrypted = cipher::invalid;
+
+        // Decodes the instruction at C
+        auto fetch = [&]() {
+            const auto c_value = mem.read(reg_c);
+            auto instr = cpu_instruction::opcode::invalid;
+            if constexpr (Fused) {
+                const auto t = cipher_transition(c_value, c_mod);
+                instr = t.instr;
+                encrypted = t.encrypted;
+            } else {
+                instr = pre_cipher_decode(c_value, reg_c);
+            }
+
+            if (instr == cpu_instruction::opcode::invalid) [[unlikely]] {
+                throw execution_exception{
+                    "Pre-cipher non-whitespace character must be graphical "
+                        "ASCII: " + std::to_string(static_cast<int>(c_value)),
+                    p_counter + steps
+                };
+            }
+            return instr;
+        };
+
+        // Must be called if C, or the value at C, changes after fetch(), as the
+        // fused post-cipher value is then stale.  The jump instruction moves C,
+        // and the rotate and op instructions write to D (which may equal C)
+        auto c_changed = [&]() {
+            if constexpr (Fused) {
+                c_mod = reg_c % cipher::size;
+                encrypted = post_cipher_encode(mem.read(reg_c));
+            }
+        };
+
+        // Post-ciphers the executed instruction and moves onto the next,
+        // returns false if the run should end
+        auto advance = [&]() {
+            auto& c_post = mem.write(reg_c);
+            const auto pc = Fused ? encrypted : post_cipher_encode(c_post);
+            if (pc == cipher::invalid) [[unlikely]] {
+                throw execution_exception{
+                    "Post-cipher non-whitespace character must be graphical "
+                        "ASCII: " + std::to_string(static_cast<int>(c_post)),
+                    p_counter + steps
+                };
+            }
+            c_post = pc;
+
+            increment(reg_c);
+            increment(reg_d);
+            if constexpr (Fused) {
+                if (++c_mod == cipher::size || !reg_c) {
+                    c_mod = 0;
+                }
+            }
+            return ++steps != max_steps && !yield();
+        };
+
+        try {
+#ifdef MALBOLGE_COMPUTED_GOTO
+            // Indexed by opcode, unknown instructions are nops.  Invalid ones
+            // never reach here as fetch() throws
+            static void* const dispatch_table[] = {
+                &&set_data_ptr,
+                &&set_code_ptr,
+                &&rotate,
+                &&op,
+                &&read,
+                &&write,
+                &&stop,
+                &&nop,
+                &&nop
+            };
+            static_assert(std::size(dispatch_table) ==
+                          static_cast<std::size_t>(cpu_instruction::opcode::invalid),
+                          "Opcodes have changed, update the dispatch table");
+
+            // A single dispatch site benchmarks faster than replicating it into
+            // every handler, as the latter is too large to be fully inlined
+#define MALBOLGE_DISPATCH_NEXT goto next
+
+            goto *dispatch_table[static_cast<std::size_t>(fetch())];
+        next:
+            if (!advance()) {
+                return finish(step_result::CONTINUE);
+            }
+            goto *dispatch_table[static_cast<std::size_t>(fetch())];
+
+        set_data_ptr:
+            reg_d = static_cast<virtual_memory::size_type>(mem.read(reg_d));
+            MALBOLGE_DISPATCH_NEXT;
+        set_code_ptr:
+            reg_c = static_cast<virtual_memory::size_type>(mem.read(reg_d));
+            c_changed();
+            MALBOLGE_DISPATCH_NEXT;
+        rotate:
+            reg_a = mem.write(reg_d).rotate();
+            if (Fused && reg_d == reg_c) {
+                c_changed();
+            }
+            MALBOLGE_DISPATCH_NEXT;
+        op:
+        {
+            auto& d_value = mem.write(reg_d);
+            reg_a = d_value = reg_a.op(d_value);
+            if (Fused && reg_d == reg_c) {
+                c_changed();
+            }
+            MALBOLGE_DISPATCH_NEXT;
+        }
+        read:
+        {
+            const auto value = input();
+            if (!value) {
+                return finish(step_result::WAITING_FOR_INPUT);
+            }
+            reg_a = *value;
+            MALBOLGE_DISPATCH_NEXT;
+        }
+        write:
+            if (reg_a != math::ternary::max) {
+                output(static_cast<char>(reg_a));
+            }
+            MALBOLGE_DISPATCH_NEXT;
+        stop:
+            return finish(step_result::STOPPED);
+        nop:
+            MALBOLGE_DISPATCH_NEXT;
+
+#undef MALBOLGE_DISPATCH_NEXT
+#else
+            while (true) {
+                switch (fetch()) {
+                case cpu_instruction::opcode::set_data_ptr:
+                    reg_d = static_cast<virtual_memory::size_type>(mem.read(reg_d));
+                    break;
+                case cpu_instruction::opcode::set_code_ptr:
+                    reg_c = static_cast<virtual_memory::size_type>(mem.read(reg_d));
+                    c_changed();
+                    break;
+                case cpu_instruction::opcode::rotate:
+                    reg_a = mem.write(reg_d).rotate();
+                    if (Fused && reg_d == reg_c) {
+                        c_changed();
+                    }
+                    break;
+                case cpu_instruction::opcode::op:
+                {
+                    auto& d_value = mem.write(reg_d);
+                    reg_a = d_value = reg_a.op(d_value);
+                    if (Fused && reg_d == reg_c) {
+                        c_changed();
+                    }
+                    break;
+                }
+                case cpu_instruction::opcode::read:
+                {
+                    const auto value = input();
+                    if (!value) {
+                        return finish(step_result::WAITING_FOR_INPUT);
+                    }
+                    reg_a = *value;
+                    break;
+                }
+                case cpu_instruction::opcode::write:
+                    if (reg_a != math::ternary::max) {
+                        output(static_cast<char>(reg_a));
+                    }
+                    break;
+                case cpu_instruction::opcode::stop:
+                    return finish(step_result::STOPPED);
+                default:
+                    // Nop
+                    break;
+                }
+
+                if (!advance()) {
+                    return finish(step_result::CONTINUE);
+                }
+            }
+#endif
+        } catch (...) {
+            finish(step_result::CONTINUE);
+            throw;
+        }
+    }
+
+    // Increments a register address, wrapping round to the start of the memory
+    // space if necessary
+    void increment(virtual_memory::size_type& reg) const noexcept
+    {
+        if (++reg == vmem.size()) [[unlikely]] {
+            reg = 0;
+        }
+    }
+};
+}
+}
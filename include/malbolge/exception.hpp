@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include "malbolge/execution_limits.hpp"
 #include "malbolge/math/ternary.hpp"
 
 #include <optional>
@@ -161,6 +162,42 @@ private:
     std::size_t step_;
 };
 
+/** Exception thrown when a virtual_cpu execution limit is reached.
+ *
+ * See virtual_cpu::set_limits(execution_limits).
+ */
+class limit_exception : public execution_exception
+{
+public:
+    /** Limit types.
+     */
+    using limit_type = execution_limits::limit_type;
+
+    /** Constructor.
+     *
+     * @param type Limit that was reached
+     * @param execution_step Instruction execution step
+     */
+    explicit limit_exception(limit_type type, std::size_t execution_step);
+
+    /** Destructor.
+     */
+    virtual ~limit_exception() = default;
+
+    /** Returns the limit that was reached.
+     *
+     * @return Limit type
+     */
+    [[nodiscard]]
+    limit_type type() const noexcept
+    {
+        return type_;
+    }
+
+private:
+    limit_type type_;
+};
+
 /** Execution thrown during virtual machine operation, not relating to Malbolge
  * program execution.
  */
@@ -0,0 +1,162 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#pragma once
+
+#include "malbolge/detail/interpreter.hpp"
+#include "malbolge/execution_limits.hpp"
+
+#include <algorithm>
+#include <string_view>
+
+namespace malbolge
+{
+/** The result of an execute(virtual_memory, std::string_view, OutputSink&&, execution_limits)
+ * call.
+ */
+struct execution_result
+{
+    /** Reason execution ended.
+     */
+    enum class status {
+        STOPPED,            ///< Stop instruction executed
+        WAITING_FOR_INPUT,  ///< Program requested more input than was given
+        LIMIT_REACHED,      ///< An execution_limits limit was reached
+        NUM_STATUSES        ///< Number of statuses
+    };
+
+    status state;       ///< Reason execution ended
+    std::size_t steps;  ///< Number of instructions executed
+
+    /** Limit that was reached, only set if @a state is
+     *  status::LIMIT_REACHED.
+     */
+    std::optional<execution_limits::limit_type> limit = {};
+};
+
+/** Textual streaming operator for execution_result::status.
+ *
+ * @param stream Output stream
+ * @param status Instance to stream
+ * @return @a stream
+ */
+std::ostream& operator<<(std::ostream& stream, execution_result::status status);
+
+/** Executes a program to completion on the calling thread.
+ *
+ * This is the synchronous counterpart to virtual_cpu, there are no threads,
+ * event loops, or signals involved - so it is the cheapest way to run a
+ * program when debugging features are not needed.
+ *
+ * @a input is given to the program in order, followed by a single EOF.  Like
+ * virtual_cpu, a null character in @a input is treated as EOF.  If the program
+ * requests input after that, execution ends with
+ * execution_result::status::WAITING_FOR_INPUT.
+ *
+ * The execution_limits::deadline is checked every few thousand instructions,
+ * so it can be overrun slightly.
+ * @tparam OutputSink Output function type, with the signature
+ * <TT>void (char)</TT>
+ * @param vmem Virtual memory containing the initialised memory space
+ * (including program data)
+ * @param input Program input
+ * @param output Called with each character the program writes
+ * @param limits Execution limits
+ * @return Execution result
+ * @exception execution_exception Thrown if the program executes an invalid
+ * instruction
+ */
+template <typename OutputSink>
+execution_result execute(virtual_memory vmem,
+                         std::string_view input,
+                         OutputSink&& output,
+                         execution_limits limits = {})
+{
+    auto core = detail::interpreter{std::move(vmem)};
+    auto eof_sent = false;
+    auto output_count = std::size_t{0};
+    auto output_limit_hit = false;
+
+    auto input_fn = [&]() -> std::optional<math::ternary> {
+        if (eof_sent) {
+            return {};
+        }
+        if (input.empty() || !input.front()) {
+            eof_sent = true;
+            return math::ternary::max;
+        }
+
+        const auto c = input.front();
+        input.remove_prefix(1);
+        return c;
+    };
+    auto output_fn = [&](char c) {
+        if (output_count == limits.max_output) {
+            output_limit_hit = true;
+            return;
+        }
+        ++output_count;
+        output(c);
+    };
+
+    // The deadline is only checked every deadline_interval instructions, so
+    // the clock isn't read per instruction
+    constexpr auto deadline_interval = std::size_t{4096};
+    using limit_type = execution_limits::limit_type;
+
+    while (true) {
+        if (core.p_counter >= limits.max_steps) {
+            return {execution_result::status::LIMIT_REACHED,
+                    core.p_counter,
+                    limit_type::STEPS};
+        }
+        if (limits.deadline &&
+            std::chrono::steady_clock::now() >= *limits.deadline) {
+            return {execution_result::status::LIMIT_REACHED,
+                    core.p_counter,
+                    limit_type::DEADLINE};
+        }
+
+        const auto end = core.p_counter +
+                         std::min(deadline_interval,
+                                  limits.max_steps - core.p_counter);
+        while (core.p_counter < end) {
+            const auto result = core.step(input_fn, output_fn);
+            if (result == detail::interpreter::step_result::STOPPED) {
+                return {execution_result::status::STOPPED, core.p_counter};
+            } else if (result == detail::interpreter::step_result::WAITING_FOR_INPUT) {
+                return {execution_result::status::WAITING_FOR_INPUT, core.p_counter};
+            } else if (output_limit_hit) [[unlikely]] {
+                return {execution_result::status::LIMIT_REACHED,
+                        core.p_counter,
+                        limit_type::OUTPUT};
+            }
+        }
+    }
+}
+
+/** Executes a program to completion on the calling thread, collecting the
+ * output into a string.
+ *
+ * @param vmem Virtual memory containing the initialised memory space
+ * (including program data)
+ * @param input Program input
+ * @param output Program output is appended to this
+ * @param limits Execution limits
+ * @return Execution result
+ * @exception execution_exception Thrown if the program executes an invalid
+ * instruction
+ */
+inline execution_result execute(virtual_memory vmem,
+                                std::string_view input,
+                                std::string& output,
+                                execution_limits limits = {})
+{
+    return execute(std::move(vmem),
+                   input,
+                   [&](char c) { output.push_back(c); },
+                   limits);
+}
+}
@@ -0,0 +1,57 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#pragma once
+
+#include <chrono>
+#include <iosfwd>
+#include <limits>
+#include <optional>
+
+namespace malbolge
+{
+/** Limits applied to program execution.
+ *
+ * Used by both execute(virtual_memory, std::string_view, OutputSink&&, execution_limits)
+ * and virtual_cpu::set_limits(execution_limits).  The defaults are unlimited.
+ */
+struct execution_limits
+{
+    /** Limit types.
+     */
+    enum class limit_type {
+        STEPS,      ///< execution_limits::max_steps reached
+        OUTPUT,     ///< execution_limits::max_output reached
+        DEADLINE,   ///< execution_limits::deadline passed
+        NUM_LIMITS  ///< Number of limit types
+    };
+
+    /** Maximum number of instructions to execute.
+     *
+     * The cut-off is always at the same instruction for the same program and
+     * input.
+     */
+    std::size_t max_steps = std::numeric_limits<std::size_t>::max();
+
+    /** Maximum number of characters to output.
+     *
+     * A write instruction that would exceed this ends execution, the
+     * character is not output.
+     */
+    std::size_t max_output = std::numeric_limits<std::size_t>::max();
+
+    /** Time at which execution is ended, if set.
+     */
+    std::optional<std::chrono::steady_clock::time_point> deadline = {};
+};
+
+/** Textual streaming operator for execution_limits::limit_type.
+ *
+ * @param stream Output stream
+ * @param type Instance to stream
+ * @return @a stream
+ */
+std::ostream& operator<<(std::ostream& stream, execution_limits::limit_type type);
+}
@@ -6,7 +6,6 @@
 #pragma once
 
 #include "malbolge/virtual_memory.hpp"
-#include "malbolge/algorithm/remove_from_range.hpp"
 #include "malbolge/log.hpp"
 #include "malbolge/normalise.hpp"
 
@@ -33,6 +32,97 @@ enum class load_normalised_mode
  */
 std::ostream& operator<<(std::ostream& stream, load_normalised_mode mode);
 
+namespace detail
+{
+/** Validates non-normalised program source and strips out the whitespace.
+ *
+ * This is a single-pass, compacting operation, and the source can be fed in
+ * over multiple calls (e.g. as chunks of a stream) - the position and line
+ * information is carried between them.
+ */
+class source_validator
+{
+public:
+    /** Validates the source in [@a first, @a last), and writes the
+     *  non-whitespace characters into @a dest.
+     *
+     * @a dest may be @a first, in which case the source is compacted in place.
+     * @tparam InputIt Input iterator type
+     * @tparam OutputIt Output iterator type
+     * @param first Iterator to the first element
+     * @param last Iterator to the one-past-the-end element
+     * @param dest Output iterator
+     * @return One-past-the-end of the written elements
+     * @exception parse_exception Thrown if the source contains errors, the
+     * location is relative to the first call
+     */
+    template <typename InputIt, typename OutputIt>
+    OutputIt operator()(InputIt first, InputIt last, OutputIt dest)
+    {
+        for (; first != last; ++first) {
+            const auto c = *first;
+            // Equivalent to std::isspace in the C locale, without the call
+            if (c == ' ' || (c >= '\t' && c <= '\r')) {
+                if (c == '\n') {
+                    ++loc_.line;
+                    loc_.column = 1;
+                } else {
+                    ++loc_.column;
+                }
+                continue;
+            }
+
+            const auto instr = pre_cipher_decode(c, size_);
+            if (instr == cpu_instruction::opcode::invalid) [[unlikely]] {
+                throw parse_exception{"Non-whitespace character must be graphical "
+                                          "ASCII: " +
+                                          std::to_string(static_cast<int>(c)),
+                                      loc_};
+            }
+
+            if (instr == cpu_instruction::opcode::unknown) [[unlikely]] {
+                // Only the error message needs the pre-ciphered character
+                throw parse_exception{"Invalid instruction in program: " +
+                                          std::to_string(static_cast<int>(
+                                              *pre_cipher_instruction(c, size_))),
+                                      loc_};
+            }
+
+            *dest = c;
+            ++dest;
+            ++loc_.column;
+            ++size_;
+        }
+
+        return dest;
+    }
+
+    /** Returns the number of instructions validated so far.
+     *
+     * @return Instruction count
+     */
+    [[nodiscard]]
+    std::size_t size() const noexcept
+    {
+        return size_;
+    }
+
+    /** Returns the source location of the next character.
+     *
+     * @return Source location
+     */
+    [[nodiscard]]
+    source_location location() const noexcept
+    {
+        return loc_;
+    }
+
+private:
+    source_location loc_;
+    std::size_t size_ = 0;
+};
+}
+
 /** Loads the program data between @a first and @a last.
  *
  * The data is modified in place, so the iterators must not be const.
@@ -77,41 +167,10 @@ virtual_memory load(InputIt first,
         // that test here
         last = denormalise_source(first, last);
     } else {
-        auto loc = source_location{};
-        auto i = 0u;
-        for (auto it = first; it != last;) {
-            if (std::isspace(*it)) {
-                if (*it == '\n') {
-                    ++loc.line;
-                    loc.column = 1;
-                } else {
-                    ++loc.column;
-                }
-
-                last = algorithm::remove_from_range(it, last);
-                continue;
-            }
-
-            auto instr = pre_cipher_instruction(*it, i);
-            if (!instr) {
-                throw parse_exception{"Non-whitespace character must be graphical "
-                                          "ASCII: " +
-                                          std::to_string(static_cast<int>(*it)),
-                                      loc};
-            }
-
-            if (!is_cpu_instruction(*instr)) {
-                throw parse_exception{"Invalid instruction in program: " +
-                                          std::to_string(static_cast<int>(*instr)),
-                                      loc};
-            }
-            ++loc.column;
-            ++it;
-            ++i;
-        }
+        last = detail::source_validator{}(first, last, first);
     }
 
-    log::print(log::DEBUG, "Loaded size: ", std::distance(first, last));
+    log::print<log::DEBUG>("Loaded size: ", std::distance(first, last));
 
     return virtual_memory(first, last);
 }
@@ -159,9 +218,26 @@ virtual_memory load(R&& range,
 virtual_memory load(const std::filesystem::path& path,
                     load_normalised_mode mode = load_normalised_mode::AUTO);
 
+/** Loads the program data read from @a stream.
+ *
+ * The stream is read in fixed size chunks until EOF, and each chunk is
+ * validated as it arrives, so memory usage is bounded by the maximum program
+ * size rather than the input size.  Error locations account for all of the
+ * input, including line breaks.
+ * @param stream Input stream
+ * @param mode Program load normalised mode
+ * @return Virtual memory image with the program at the start
+ * @exception parse_exception Thrown if the stream cannot be read or the
+ * program contains errors
+ */
+[[nodiscard]]
+virtual_memory load_from_stream(std::istream& stream,
+                                load_normalised_mode mode = load_normalised_mode::AUTO);
+
 /** Loads the program data from std::cin.
  *
- * This is used for 'piping' data in from a terminal.
+ * This is used for 'piping' data in from a terminal, and is equivalent to
+ * <TT>load_from_stream(std::cin, mode)</TT>.
  * @param mode Program load normalised mode
  * @return Virtual memory image with the program at the start
  * @exception parse_exception Thrown if the program contains errors
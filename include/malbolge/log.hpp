@@ -7,6 +7,14 @@
 
 #include <iostream>
 #include <mutex>
+#include <tuple>
+
+#ifndef MALBOLGE_LOG_LEVEL_FLOOR
+/** Minimum log level that can be printed, set via the LOG_LEVEL_FLOOR CMake
+ *  cache variable.
+ */
+#define MALBOLGE_LOG_LEVEL_FLOOR VERBOSE_DEBUG
+#endif
 
 namespace malbolge
 {
@@ -30,6 +38,14 @@ enum level {
     NUM_LOG_LEVELS  ///< Number of log levels
 };
 
+/** Compile-time minimum log level.
+ *
+ * Calls to print<Lvl>(Args&&...) and print_lazy<Lvl>(Fn&&) with a level below
+ * this are compiled out entirely, and set_log_level(level) cannot enable them.
+ */
+constexpr auto log_level_floor = level::MALBOLGE_LOG_LEVEL_FLOOR;
+static_assert(log_level_floor < NUM_LOG_LEVELS, "Invalid log level floor");
+
 /** String conversion for @a lvl.
  *
  * @param lvl Log level
@@ -127,11 +143,60 @@ void print(level lvl, Args&&... args)
 {
     static_assert(sizeof...(Args) > 0, "Must be at least one argument");
 
-    if (lvl >= log_level()) {
+    if (lvl >= log_level_floor && lvl >= log_level()) {
         basic_print(std::clog, detail::log_level_to_colour(lvl),
                     "[", lvl, "]: ",
                     std::forward<Args>(args)...);
     }
 }
+
+/** Prints the log message, with the log level fixed at compile-time.
+ *
+ * Identical to print(level, Args&&...), except that if @a Lvl is less than
+ * log_level_floor then the call compiles to nothing.
+ * @code
+ * log::print<log::DEBUG>("File size: ", file_size);
+ * @endcode
+ * @tparam Lvl Log level
+ * @tparam Args Message argument types
+ * @param args Message arguments
+ */
+template <level Lvl, typename... Args>
+void print(Args&&... args)
+{
+    if constexpr (Lvl >= log_level_floor) {
+        print(Lvl, std::forward<Args>(args)...);
+    }
+}
+
+/** Prints the log message, only generating the message arguments if the
+ *  message will be printed.
+ *
+ * @a fn returns the message arguments as a tuple, and is only called if
+ * @a Lvl is not less than log_level_floor and log_level().  This is intended
+ * for hot paths, where even evaluating the message arguments of a filtered
+ * message is too expensive:
+ * @code
+ * log::print_lazy<log::VERBOSE_DEBUG>([&]() {
+ *     return std::tuple{"Step: ", p_counter, ", instr: ", instr};
+ * });
+ * @endcode
+ * @tparam Lvl Log level
+ * @tparam Fn Message argument generator type, with the signature
+ * <TT>std::tuple<Args...> ()</TT>
+ * @param fn Message argument generator
+ */
+template <level Lvl, typename Fn>
+void print_lazy(Fn&& fn)
+{
+    if constexpr (Lvl >= log_level_floor) {
+        if (Lvl >= log_level()) {
+            std::apply([](auto&&... args) {
+                           print(Lvl, std::forward<decltype(args)>(args)...);
+                       },
+                       std::forward<Fn>(fn)());
+        }
+    }
+}
 }
 }
@@ -7,6 +7,7 @@
 
 #include "malbolge/math/tritset.hpp"
 
+#include <limits>
 #include <optional>
 
 /** Top-level namespace for all of malbolge.
@@ -32,6 +33,14 @@ public:
      */
     using underlying_type = std::uint32_t;
 
+    /** Storage integer type.
+     *
+     * The value is stored in the narrowest type that can hold max, rather than
+     * underlying_type.  This halves the size of a virtual_memory instance,
+     * arithmetic is still performed using underlying_type.
+     */
+    using storage_type = std::uint16_t;
+
     /** Tritset storage type.
      */
     using tritset_type = tritset<10, std::uint32_t>;
@@ -40,13 +49,38 @@ public:
      */
     static constexpr auto max = tritset_type::max;
 
+    static_assert(max <= std::numeric_limits<storage_type>::max(),
+                  "Storage type too narrow for maximum ternary value");
+
+    /** Implementation backends for op(const ternary&) and rotate(std::size_t).
+     */
+    enum class backend {
+        TRITWISE,       ///< Reference implementation, converts to a tritset
+                        ///< and operates on each trit individually
+        TABLE,          ///< Uses precomputed lookup tables and constant
+                        ///< arithmetic, avoiding the tritset conversion
+        NUM_BACKENDS    ///< Number of backends
+    };
+
+    /** The backend used when one is not explicitly specified.
+     *
+     * This is backend::TABLE unless <TT>MALBOLGE_TERNARY_TRITWISE_BACKEND</TT>
+     * is defined (set via the <TT>TERNARY_TRITWISE_BACKEND</TT> CMake option).
+     */
+    static constexpr auto default_backend =
+#ifdef MALBOLGE_TERNARY_TRITWISE_BACKEND
+        backend::TRITWISE;
+#else
+        backend::TABLE;
+#endif
+
     /** Constructor.
      *
      * If @a value exceeds max, then it is wrapped.
      * @param value Value to initialise with
      */
     constexpr ternary(underlying_type value = 0) noexcept :
-        v_{value % (max+1)}
+        v_{static_cast<storage_type>(value % (max+1))}
     {}
 
     /** Tritset constructor.
@@ -116,7 +150,7 @@ public:
     [[nodiscard]]
     constexpr ternary operator+(const ternary& other) const noexcept
     {
-        return v_ + other.v_;
+        return underlying_type{v_} + other.v_;
     }
 
     /** Addition assignment operator.
@@ -137,7 +171,9 @@ public:
     [[nodiscard]]
     constexpr ternary operator-(const ternary& other) const noexcept
     {
-        return other.v_ > v_ ? max - (other.v_ - v_) : v_ - other.v_;
+        const auto a = underlying_type{v_};
+        const auto b = underlying_type{other.v_};
+        return b > a ? max - (b - a) : a - b;
     }
 
     /** Subtraction assignment operator.
@@ -158,7 +194,7 @@ public:
     [[nodiscard]]
     constexpr ternary operator%(const ternary& other) const noexcept
     {
-        return v_ % other.v_;
+        return underlying_type{v_} % other.v_;
     }
 
     /** Modulo assignment operator.
@@ -173,10 +209,11 @@ public:
 
     /** Rotates the trits to the right (i.e. least-significant).
      *
-     * 
+     * @tparam B Implementation backend
      * @param i Number of positions to rotate, modulo-ed to width before use
      * @return A reference to this
      */
+    template <backend B = default_backend>
     ternary& rotate(std::size_t i = 1) noexcept;
 
     /** @em The operation.
@@ -213,16 +250,34 @@ public:
      *  </tr>
      *  </table>
      *
+     * The backend::TABLE implementation splits each operand into two 5 trit
+     * halves and looks up the result of each half in a precomputed 243x243
+     * table.
+     * @tparam B Implementation backend
      * @param other Instance to operate against
      * @return Operation result
      */
+    template <backend B = default_backend>
     [[nodiscard]]
     ternary op(const ternary& other) const noexcept;
 
 private:
-    underlying_type v_;
+    storage_type v_;
 };
 
+extern template ternary& ternary::rotate<ternary::backend::TRITWISE>(std::size_t) noexcept;
+extern template ternary& ternary::rotate<ternary::backend::TABLE>(std::size_t) noexcept;
+extern template ternary ternary::op<ternary::backend::TRITWISE>(const ternary&) const noexcept;
+extern template ternary ternary::op<ternary::backend::TABLE>(const ternary&) const noexcept;
+
+/** Textual streaming operator for ternary::backend.
+ *
+ * @param stream Output stream
+ * @param b Backend
+ * @return @a stream
+ */
+std::ostream& operator<<(std::ostream& stream, ternary::backend b);
+
 /** Textual streaming operator.
  *
  * @param stream Output stream
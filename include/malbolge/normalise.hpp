@@ -9,8 +9,163 @@
 #include "malbolge/cpu_instruction.hpp"
 #include "malbolge/exception.hpp"
 
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+
 namespace malbolge
 {
+namespace detail
+{
+// Character classification flags, used instead of std::isspace and searching
+// cpu_instruction::all, so that the per-character work is a single load
+enum char_class : std::uint8_t {
+    CC_SPACE        = 1 << 0,   // Whitespace in the C locale
+    CC_INSTRUCTION  = 1 << 1,   // Normalised vCPU instruction
+};
+
+constexpr auto char_classes = []() {
+    auto table = std::array<std::uint8_t, 256>{};
+    for (auto c : {' ', '\t', '\n', '\v', '\f', '\r'}) {
+        table[static_cast<unsigned char>(c)] |= CC_SPACE;
+    }
+    for (auto c : cpu_instruction::all) {
+        table[static_cast<unsigned char>(c)] |= CC_INSTRUCTION;
+    }
+    return table;
+}();
+
+// The denormalised character for each normalised instruction at program
+// position 0, or 0 if not an instruction
+constexpr auto denormalise_map = []() {
+    constexpr auto map = std::array{
+        std::array<char, 2>{cpu_instruction::rotate,         '\''},
+        std::array<char, 2>{cpu_instruction::set_data_ptr,   '('},
+        std::array<char, 2>{cpu_instruction::op,             '>'},
+        std::array<char, 2>{cpu_instruction::nop,            'D'},
+        std::array<char, 2>{cpu_instruction::stop,           'Q'},
+        std::array<char, 2>{cpu_instruction::set_code_ptr,   'b'},
+        std::array<char, 2>{cpu_instruction::write,          'c'},
+        std::array<char, 2>{cpu_instruction::read,           'u'}
+    };
+    static_assert(map.size() == cpu_instruction::all.size(),
+                  "CPU instruction list changed without updating normalisation map");
+
+    auto table = std::array<char, 256>{};
+    for (auto [instr, c] : map) {
+        table[static_cast<unsigned char>(instr)] = c;
+    }
+    return table;
+}();
+
+template <typename Table, typename T>
+[[nodiscard]]
+constexpr typename Table::value_type char_lookup(const Table& table, T c) noexcept
+{
+    if constexpr (sizeof(T) == 1) {
+        return table[static_cast<unsigned char>(c)];
+    } else {
+        const auto i = static_cast<std::size_t>(c);
+        return i < table.size() ? table[i] : typename Table::value_type{0};
+    }
+}
+
+template <typename T>
+[[nodiscard]]
+constexpr bool is_space(T c) noexcept
+{
+    return char_lookup(char_classes, c) & CC_SPACE;
+}
+
+/** Instruction sets that the vectorised normalisation kernels can use.
+ */
+enum class simd_level {
+    NONE,       ///< Lookup tables only
+    SSE4_2,     ///< 16 characters at a time
+    AVX2,       ///< 32 characters at a time
+    NUM_LEVELS  ///< Number of levels
+};
+
+/** Returns the highest simd_level supported by the CPU.
+ *
+ * This is always simd_level::NONE on non-x86 targets.
+ * @return SIMD level
+ */
+[[nodiscard]]
+simd_level max_simd_level() noexcept;
+
+/** Returns the simd_level the kernels are currently using.
+ *
+ * This defaults to max_simd_level().
+ * @return SIMD level
+ */
+[[nodiscard]]
+simd_level active_simd_level() noexcept;
+
+/** Sets the simd_level the kernels use, clamped to max_simd_level().
+ *
+ * This only exists so that the tests and benchmarks can compare the kernels
+ * against the lookup table implementation.
+ * @param level SIMD level
+ */
+void set_simd_level(simd_level level) noexcept;
+
+/** True if the normalisation functions can pass @a InputIt's data to the
+ *  vectorised kernels.
+ */
+#ifdef EMSCRIPTEN
+template <typename InputIt>
+constexpr auto is_simd_iterator = false;
+#else
+template <typename InputIt>
+constexpr auto is_simd_iterator =
+    std::contiguous_iterator<InputIt> &&
+    std::is_same_v<std::iter_value_t<InputIt>, char>;
+#endif
+
+/** normalise_prefix(char*, std::size_t) result.
+ */
+struct normalise_progress
+{
+    std::size_t read = 0;       ///< Number of source characters consumed
+    std::size_t written = 0;    ///< Number of instructions written
+    source_location loc;        ///< Location of the next source character
+};
+
+/** Vectorised normalise_source(InputIt, InputIt) kernel.
+ *
+ * Normalises @a data in place until it reaches the last partial block, or a
+ * character that needs a diagnostic, leaving the rest to the caller.
+ * @param data Source data
+ * @param size Number of characters in @a data
+ * @return Progress made
+ */
+[[nodiscard]]
+normalise_progress normalise_prefix(char* data, std::size_t size) noexcept;
+
+/** Vectorised denormalise_source(InputIt, InputIt) kernel.
+ *
+ * Denormalises whole blocks of @a data in place, up to the last partial block
+ * or the first block containing a non-instruction.
+ * @param data Normalised source data, without trailing whitespace
+ * @param size Number of characters in @a data
+ * @return Number of characters denormalised
+ */
+[[nodiscard]]
+std::size_t denormalise_prefix(char* data, std::size_t size) noexcept;
+
+/** Vectorised is_likely_normalised_source(InputIt, InputIt) kernel.
+ *
+ * @param data Source data
+ * @param size Number of characters in @a data
+ * @return Number of leading characters, in whole blocks, that are all vCPU
+ * instructions
+ */
+[[nodiscard]]
+std::size_t instruction_prefix(const char* data, std::size_t size) noexcept;
+}
+
 /** 'Normalises' a Malbolge program.
  *
  * In Malbolge the position of an instruction changes its meaning, this function
@@ -43,9 +198,20 @@ InputIt normalise_source(InputIt first, InputIt last)
                   "InputIt must not be a const iterator");
 
     auto loc = source_location{};
-    auto i = 0u;
-    for (auto it = first; it != last; ++it) {
-        if (std::isspace(*it)) {
+    auto i = std::size_t{0};
+    auto it = first;
+    if constexpr (detail::is_simd_iterator<InputIt>) {
+        const auto progress = detail::normalise_prefix(
+            std::to_address(first),
+            static_cast<std::size_t>(last - first));
+        it += progress.read;
+        first += progress.written;
+        loc = progress.loc;
+        i = progress.written;
+    }
+
+    for (; it != last; ++it) {
+        if (detail::is_space(*it)) {
             if (*it == '\n') {
                 ++loc.line;
                 loc.column = 1;
@@ -56,21 +222,23 @@ InputIt normalise_source(InputIt first, InputIt last)
             continue;
         }
 
-        auto instr = pre_cipher_instruction(*it, i);
-        if (!instr) {
+        const auto instr = pre_cipher_decode(*it, i);
+        if (instr == cpu_instruction::opcode::invalid) [[unlikely]] {
             throw parse_exception{"Non-whitespace character must be graphical "
                                       "ASCII: " +
                                       std::to_string(static_cast<int>(*it)),
                                   loc};
         }
 
-        if (!is_cpu_instruction(*instr)) {
+        if (instr == cpu_instruction::opcode::unknown) [[unlikely]] {
+            // Only the error message needs the pre-ciphered character
             throw parse_exception{"Invalid instruction in program: " +
-                                      std::to_string(static_cast<int>(*instr)),
+                                      std::to_string(static_cast<int>(
+                                          *pre_cipher_instruction(*it, i))),
                                   loc};
         }
 
-        *first++ = *instr;
+        *first++ = cpu_instruction::to_type(instr);
         ++loc.column;
         ++i;
     }
@@ -141,38 +309,38 @@ InputIt denormalise_source(InputIt first, InputIt last)
 #endif
                   "InputIt must not be a const iterator");
 
-    algorithm::trim_right(first, last, [](auto c) { return std::isspace(c); });
+    algorithm::trim_right(first, last, [](auto c) { return detail::is_space(c); });
 
-    constexpr auto map = std::array{
-        std::array<char, 2>{cpu_instruction::rotate,         '\''},
-        std::array<char, 2>{cpu_instruction::set_data_ptr,   '('},
-        std::array<char, 2>{cpu_instruction::op,             '>'},
-        std::array<char, 2>{cpu_instruction::nop,            'D'},
-        std::array<char, 2>{cpu_instruction::stop,           'Q'},
-        std::array<char, 2>{cpu_instruction::set_code_ptr,   'b'},
-        std::array<char, 2>{cpu_instruction::write,          'c'},
-        std::array<char, 2>{cpu_instruction::read,           'u'}
-    };
-    static_assert(map.size() == cpu_instruction::all.size(),
-                  "CPU instruction list changed without updating normalisation map");
+    // Track the position modulo the cipher size, rather than calculating it
+    // for every character
+    auto offset = 0;
+    auto i = std::size_t{0};
+    if constexpr (detail::is_simd_iterator<InputIt>) {
+        i = detail::denormalise_prefix(std::to_address(first),
+                                       static_cast<std::size_t>(last - first));
+        first += i;
+        offset = static_cast<int>(i % cipher::size);
+    }
 
-    for (auto i = 0u; first != last; ++first, ++i) {
-        auto m_it = std::find_if(map.begin(), map.end(), [&](auto k) {
-                return *first == k.front();
-        });
-        if (m_it == map.end()) {
+    for (; first != last; ++first, ++i) {
+        const auto mapped = detail::char_lookup(detail::denormalise_map, *first);
+        if (!mapped) [[unlikely]] {
             throw parse_exception{"Invalid instruction in program: " +
                                       std::to_string(static_cast<int>(*first)),
-                                  source_location{1, i+1}};
+                                  source_location{
+                                      1,
+                                      static_cast<math::ternary::underlying_type>(i+1)
+                                  }};
         }
 
-        const auto offset = static_cast<int>(i % cipher::size);
-        const auto sub = static_cast<int>((*m_it).back()) - offset;
-
+        auto sub = static_cast<int>(mapped) - offset;
         if (sub < graphical_ascii_range.first) {
-            *first = static_cast<char>(sub + cipher::size);
-        } else {
-            *first = static_cast<char>(sub);
+            sub += cipher::size;
+        }
+        *first = static_cast<char>(sub);
+
+        if (++offset == cipher::size) {
+            offset = 0;
         }
     }
 
@@ -233,9 +401,18 @@ template <typename InputIt>
 [[nodiscard]]
 constexpr bool is_likely_normalised_source(InputIt first, InputIt last) noexcept
 {
-    algorithm::trim_right(first, last, [](auto c) { return std::isspace(c); });
+    algorithm::trim_right(first, last, [](auto c) { return detail::is_space(c); });
+    if constexpr (detail::is_simd_iterator<InputIt>) {
+        if (!std::is_constant_evaluated()) {
+            first += detail::instruction_prefix(
+                std::to_address(first),
+                static_cast<std::size_t>(last - first));
+        }
+    }
+
     for (; first != last; ++first) {
-        if (!is_cpu_instruction(*first)) {
+        if (!(detail::char_lookup(detail::char_classes, *first) &
+              detail::CC_INSTRUCTION)) {
             return false;
         }
     }
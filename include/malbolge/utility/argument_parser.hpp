@@ -6,6 +6,7 @@
 #pragma once
 
 #include "malbolge/log.hpp"
+#include "malbolge/corpus.hpp"
 
 #include <optional>
 #include <filesystem>
@@ -38,6 +39,14 @@ public:
         std::string data;       ///< Data associated with the source type
     };
 
+    /** Corpus processing arguments.
+     */
+    struct corpus_data {
+        corpus_operation op;                            ///< Operation to apply
+        std::vector<std::filesystem::path> dirs;        ///< Input directories
+        std::optional<std::filesystem::path> output_dir;///< Output directory
+    };
+
     /** Constructor.
      *
      * Parses the command line arguments.
@@ -118,6 +127,19 @@ public:
         return debugger_script_;
     }
 
+    /** Returns the corpus processing arguments, or an empty optional if not
+     *  in corpus mode.
+     *
+     * In corpus mode there is no program to run, so program() should be
+     * ignored.
+     * @return Corpus processing arguments, if specified
+     */
+    [[nodiscard]]
+    const std::optional<corpus_data>& corpus() const noexcept
+    {
+        return corpus_;
+    }
+
 private:
     bool help_;
     bool version_;
@@ -125,6 +147,7 @@ private:
     log::level log_level_;
     bool force_nn_;
     std::optional<std::filesystem::path> debugger_script_;
+    std::optional<corpus_data> corpus_;
 };
 
 /** Prints the program source into @a stream.
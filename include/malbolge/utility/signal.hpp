@@ -9,8 +9,7 @@
 #include <mutex>
 #include <functional>
 #include <memory>
-
-#include <boost/container/flat_map.hpp>
+#include <vector>
 
 // It would have been nice to use boost::signals2 for this, but only the latest
 // version (1.75) compiles in C++20 mode.  So I've gone for creating a simple
@@ -24,6 +23,17 @@ namespace utility
  * When called, calls each of the connected slot functions and passes copies of
  * @a Args instances to each one.
  *
+ * Signals are connected to rarely but can be fired very frequently (e.g. for
+ * every character of program output), so the connected slots are held in an
+ * immutable list that is atomically swapped on connection and disconnection.
+ * Firing the signal just takes a reference to the current list, it does not
+ * lock a mutex or allocate.  A consequence of this is that a slot disconnected
+ * during a signal firing on another thread may still be called once more.
+ *
+ * Many signals are fired with nothing connected, so the number of slots is
+ * also held in a plain atomic counter, and firing with no slots is a single
+ * relaxed load.
+ *
  * This class is threadsafe.  This class can be copied and moved.
  * @tparam Args Argument types
  */
@@ -63,8 +73,7 @@ public:
         {
             auto owner = owner_.lock();
             if (owner) {
-                auto lk = std::lock_guard{owner->mtx};
-                owner->fns.erase(id_);
+                owner->disconnect(id_);
             }
         }
 
@@ -92,11 +101,11 @@ public:
     signal(const signal& other) :
         signal()
     {
+        // The slot list is immutable, so it can be shared until either
+        // signal's connections change
         auto other_lk = std::lock_guard{other.impl_->mtx};
-        auto lk = std::lock_guard{impl_->mtx};
-
         impl_->new_id = other.impl_->new_id;
-        impl_->fns = other.impl_->fns;
+        impl_->store(other.impl_->load());
     }
 
     /** Move constructor.
@@ -119,49 +128,104 @@ public:
     {
         auto lk = std::lock_guard{impl_->mtx};
 
-        auto& id = impl_->new_id;
-        auto slot_ptr = std::make_shared<slot_type>(std::move(slot));
-        impl_->fns.emplace(id, std::move(slot_ptr));
+        const auto id = impl_->new_id++;
+        auto fns = std::make_shared<slot_list>(*impl_->load());
+        fns->push_back({id, std::move(slot)});
+        impl_->store(std::move(fns));
 
-        return {std::weak_ptr<impl_t>{impl_}, id++};
+        return {std::weak_ptr<impl_t>{impl_}, id};
     }
 
     /** Call each of the connected slots with @a args.
      *
      * @param args Arguments to pass to each slot
      */
-    void operator()(Args... args)
+    void operator()(Args... args) const
     {
-        // Make a shallow copy of the slot map so that we don't have the lock
-        // held whilst calling the slots
-        auto fns = fn_map{};
-        {
-            auto lk = std::lock_guard{impl_->mtx};
-            fns = impl_->fns;
+        if (!impl_->size()) {
+            return;
         }
 
-        for (auto [id, fn] : fns) {
-            (*fn)(args...);
+        const auto fns = impl_->load();
+        for (const auto& entry : *fns) {
+            entry.fn(args...);
         }
     }
 
 private:
-    using fn_map = boost::container::flat_map<size_t, std::shared_ptr<slot_type>>;
+    struct slot_entry
+    {
+        std::size_t id;
+        slot_type fn;
+    };
+    using slot_list = std::vector<slot_entry>;
+    using slot_list_ptr = std::shared_ptr<const slot_list>;
 
     struct impl_t
     {
-        friend class connection;
-
         impl_t() :
-            new_id{0}
+            new_id{0},
+            size_{0},
+            fns_{std::make_shared<const slot_list>()}
+        {}
+
+        // A stale value only means that a concurrent connect or disconnect
+        // isn't seen yet, which is already the case for the slot list
+        [[nodiscard]]
+        std::size_t size() const noexcept
         {
-            // Avoid re-allocation for common scenarios
-            fns.reserve(5);
+            return size_.load(std::memory_order_relaxed);
         }
 
+        [[nodiscard]]
+        slot_list_ptr load() const noexcept
+        {
+#ifdef __cpp_lib_atomic_shared_ptr
+            return fns_.load(std::memory_order_acquire);
+#else
+            return std::atomic_load_explicit(&fns_, std::memory_order_acquire);
+#endif
+        }
+
+        void store(slot_list_ptr fns) noexcept
+        {
+            size_.store(fns->size(), std::memory_order_relaxed);
+#ifdef __cpp_lib_atomic_shared_ptr
+            fns_.store(std::move(fns), std::memory_order_release);
+#else
+            std::atomic_store_explicit(&fns_,
+                                       std::move(fns),
+                                       std::memory_order_release);
+#endif
+        }
+
+        void disconnect(std::size_t id)
+        {
+            auto lk = std::lock_guard{mtx};
+
+            auto fns = std::make_shared<slot_list>();
+            const auto current = load();
+            fns->reserve(current->size());
+            for (const auto& entry : *current) {
+                if (entry.id != id) {
+                    fns->push_back(entry);
+                }
+            }
+            store(std::move(fns));
+        }
+
+        // Serialises writers, readers never take it
         std::mutex mtx;
         std::size_t new_id;
-        fn_map fns;
+
+    private:
+        std::atomic<std::size_t> size_;
+#ifdef __cpp_lib_atomic_shared_ptr
+        std::atomic<slot_list_ptr> fns_;
+#else
+        // libc++ does not support std::atomic<std::shared_ptr<T>> yet
+        slot_list_ptr fns_;
+#endif
     };
 
     std::shared_ptr<impl_t> impl_;
@@ -7,6 +7,8 @@
 
 #include "malbolge/utility/from_chars.hpp"
 
+#include <algorithm>
+#include <array>
 #include <string>
 #include <optional>
 #include <unordered_map>
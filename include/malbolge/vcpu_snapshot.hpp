@@ -0,0 +1,115 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#pragma once
+
+#include "malbolge/virtual_memory.hpp"
+
+#include <filesystem>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace malbolge
+{
+/** The complete execution state of a virtual_cpu.
+ *
+ * Restoring a snapshot resumes execution from the exact instruction boundary
+ * it was taken at, including any partially consumed input and breakpoint
+ * ignore counts.
+ *
+ * Snapshots are taken with virtual_cpu::snapshot(snapshot_callback_type),
+ * and restored with either virtual_cpu::restore(vcpu_snapshot) or the
+ * virtual_cpu snapshot constructors.
+ *
+ * This class can not be copied, but can be moved.
+ */
+struct vcpu_snapshot
+{
+    /** Breakpoint state.
+     */
+    struct breakpoint
+    {
+        /** Address the breakpoint resides at.
+         */
+        math::ternary address;
+
+        /** Number of times the breakpoint is still to be ignored.
+         */
+        std::size_t ignore_count = 0;
+
+        /** True if the breakpoint has just fired at the current C address, and
+         * so will be skipped when execution resumes.
+         */
+        bool hit = false;
+    };
+
+    /** Virtual memory.
+     */
+    virtual_memory vmem;
+
+    math::ternary a;                    ///< Accumulator register
+    virtual_memory::size_type c = 0;    ///< Code pointer register
+    virtual_memory::size_type d = 0;    ///< Data pointer register
+    std::size_t p_counter = 0;          ///< Number of instructions executed
+
+    /** Pending input, in the order it was added.
+     *
+     * Each entry is the unread remainder of an add_input(std::string) call,
+     * an empty entry still ends its input with an EOF as normal.  Like
+     * add_input(std::string), an entry ends at its first null character.
+     */
+    std::vector<std::string> input;
+
+    /** Breakpoints, sorted by address.
+     */
+    std::vector<breakpoint> breakpoints;
+
+    /** Number of characters output, as counted against
+     *  execution_limits::max_output.
+     */
+    std::size_t output_count = 0;
+};
+
+/** Writes @a snapshot to @a stream in a compact binary format.
+ *
+ * Memory cells that follow the standard fill pattern (i.e. each is the
+ * ternary op of the previous two) are stored as a single bit each, so
+ * the memory of a typical program takes ~8KB rather than ~118KB.
+ * @param snapshot Snapshot to write
+ * @param stream Output stream
+ * @exception system_exception Thrown if @a stream cannot be written to
+ */
+void save_snapshot(const vcpu_snapshot& snapshot, std::ostream& stream);
+
+/** Writes @a snapshot to the file at @a path.
+ *
+ * The file is replaced if it already exists.
+ * @param snapshot Snapshot to write
+ * @param path File path
+ * @exception system_exception Thrown if the file cannot be written to
+ */
+void save_snapshot(const vcpu_snapshot& snapshot, const std::filesystem::path& path);
+
+/** Reads a snapshot written by save_snapshot(const vcpu_snapshot&, std::ostream&).
+ *
+ * @param stream Input stream
+ * @return Snapshot
+ * @exception parse_exception Thrown if the data is not a valid snapshot, or if
+ * @a stream cannot be read
+ */
+[[nodiscard]]
+vcpu_snapshot load_snapshot(std::istream& stream);
+
+/** Reads a snapshot from the file at @a path.
+ *
+ * @param path File path
+ * @return Snapshot
+ * @exception parse_exception Thrown if the file is not a valid snapshot, or if
+ * it cannot be read
+ */
+[[nodiscard]]
+vcpu_snapshot load_snapshot(const std::filesystem::path& path);
+}
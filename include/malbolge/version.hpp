@@ -0,0 +1,29 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#pragma once
+
+/** @file
+ *
+ * This file is automatically generated by the build system, do not manually
+ * modify it.  If you need to change the template, it is located in
+ * malbolge/cmake/version.hpp.in
+ */
+
+namespace malbolge
+{
+/** Project version as a SymVers-style string.
+ */
+constexpr auto project_version = "0.0.3";
+
+/** Git revision.
+ */
+constexpr auto git_revision = "7c8ba7b2594bf2bd948249bf1b3ac1e693bfbbe9";
+
+/** Full version string.
+ */
+constexpr auto version_string = "0.0.3.7c8ba7b2594bf2bd948249bf1b3ac1e693bfbbe9";
+}
+
@@ -5,9 +5,18 @@
 
 #pragma once
 
+#include "malbolge/execution_limits.hpp"
 #include "malbolge/utility/signal.hpp"
+#include "malbolge/vcpu_snapshot.hpp"
 #include "malbolge/virtual_memory.hpp"
 
+#include <string_view>
+
+namespace boost::asio
+{
+class io_context;
+}
+
 namespace malbolge
 {
 /** Represents a virtual CPU.
@@ -38,6 +47,20 @@ public:
         NUM_REGISTERS   ///< Number of registers
     };
 
+    /** Interpreter engine.
+     *
+     * The engines are functionally identical, they only differ in performance.
+     */
+    enum class engine_type {
+        STANDARD,   ///< Executes one instruction at a time
+        THREADED,   ///< Direct-threaded dispatch, with the registers held in
+                    ///< locals for each run burst.  Only used whilst there are
+                    ///< no breakpoints set, otherwise STANDARD is used
+        FUSED,      ///< As THREADED, but decodes and post-ciphers each
+                    ///< instruction with a single table lookup
+        NUM_ENGINES ///< Number of engines
+    };
+
     /** Signal type to indicate the program running state, and any exception in
      *  case of error.
      *
@@ -53,6 +76,18 @@ public:
      */
     using output_signal_type = utility::signal<char>;
 
+    /** Signal type carrying buffered program output data.
+     *
+     * The string view is only valid for the duration of the slot call.
+     * @tparam std::string_view Characters output from program
+     */
+    using buffered_output_signal_type = utility::signal<std::string_view>;
+
+    /** Maximum number of characters buffered before the buffered output signal
+     *  is fired.
+     */
+    static constexpr auto output_buffer_size = std::size_t{4096};
+
     /** Signal type fired when a breakpoint is hit.
      *
      * @tparam math::ternary Address the breakpoint resides at
@@ -80,6 +115,12 @@ public:
                             std::optional<math::ternary> address,
                             math::ternary value)>;
 
+    /** Snapshot result callback type.
+     *
+     * @param snapshot The vCPU's state when the request was processed
+     */
+    using snapshot_callback_type = std::function<void (vcpu_snapshot snapshot)>;
+
     /** Constructor.
      *
      * Although it is not emitted in the state signal, the instance begins in
@@ -89,6 +130,48 @@ public:
      */
     explicit virtual_cpu(virtual_memory vmem);
 
+    /** External event loop constructor.
+     *
+     * Rather than creating its own thread and event loop, the vCPU is executed
+     * on @a ctx.  This allows many vCPUs to be multiplexed onto an
+     * application-owned thread pool.  All vCPU processing is serialised, so
+     * @a ctx can be ran by any number of threads.
+     *
+     * The vCPU does not keep @a ctx alive (i.e. it does not hold a work guard),
+     * it is up to the caller to keep it running for as long as the vCPU is in
+     * use.  Exceptions do not propagate out of @a ctx, instead the state
+     * signal is fired with execution_state::STOPPED and the exception.
+     *
+     * On destruction any queued requests are discarded, and the final
+     * execution_state::STOPPED state signal is fired from @a ctx - so
+     * connected slots must remain valid until then.
+     * @param vmem Virtual memory containing the initialised memory space
+     * (including program data)
+     * @param ctx Event loop to execute on, must outlive this instance
+     */
+    virtual_cpu(virtual_memory vmem, boost::asio::io_context& ctx);
+
+    /** Snapshot constructor.
+     *
+     * The vCPU begins in a execution_state::READY state, and run() resumes
+     * execution from where @a snapshot was taken.
+     * @param snapshot vCPU state to restore
+     * @exception execution_exception Thrown if @a snapshot's C or D registers
+     * are out of range, or it has more than one breakpoint at an address
+     */
+    explicit virtual_cpu(vcpu_snapshot snapshot);
+
+    /** External event loop snapshot constructor.
+     *
+     * See virtual_cpu(virtual_memory, boost::asio::io_context&) for the
+     * event loop requirements.
+     * @param snapshot vCPU state to restore
+     * @param ctx Event loop to execute on, must outlive this instance
+     * @exception execution_exception Thrown if @a snapshot's C or D registers
+     * are out of range, or it has more than one breakpoint at an address
+     */
+    virtual_cpu(vcpu_snapshot snapshot, boost::asio::io_context& ctx);
+
     /** Move constructor.
      *
      * @param other Instance to move from
@@ -110,6 +193,11 @@ public:
     ~virtual_cpu();
 
     /** Runs or resumes program execution.
+     *
+     * Instructions are executed in bursts on the vCPU's event loop, the burst
+     * yields early if a request (e.g. pause(), step(), add_input(std::string),
+     * etc.) is queued, so requests are still processed on the next instruction
+     * boundary.
      *
      * If the program is already running or waiting-for-input, then this is a
      * no-op.
@@ -153,6 +241,38 @@ public:
      */
     void add_input(std::string data);
 
+    /** Sets the interpreter engine.
+     *
+     * This can be called in any state, it takes effect from the next run
+     * burst.  The default is engine_type::STANDARD.
+     * @param engine Interpreter engine
+     * @exception execution_exception Thrown if backend has been destroyed,
+     * usually as a result of use-after-move
+     */
+    void set_engine(engine_type engine);
+
+    /** Sets the execution limits, replacing any previously set.
+     *
+     * When a limit is reached the vCPU is stopped, and the state signal is
+     * fired with execution_state::STOPPED and a limit_exception identifying
+     * the limit.
+     *
+     * The instruction and output limits are compared against the totals since
+     * the vCPU was constructed (including any restored from a snapshot).  The
+     * run bursts are sized so they never overshoot the instruction limit, so
+     * the cut-off is at the same instruction as execute() for the same program
+     * and input.  Unlike the other limits, the deadline applies in every
+     * state, so it also stops a vCPU that is paused or waiting for input.
+     *
+     * This can be called in any state, it takes effect from the next
+     * instruction boundary.  If the instruction or output limit has already
+     * been reached, the vCPU is stopped when it next runs or steps.
+     * @param limits Execution limits
+     * @exception execution_exception Thrown if backend has been destroyed,
+     * usually as a result of use-after-move
+     */
+    void set_limits(execution_limits limits);
+
     /** Adds a breakpoint to the program.
      *
      * If another breakpoint is already at the given address, it is replaced.
@@ -200,12 +320,39 @@ public:
      */
     void register_value(vcpu_register reg, register_value_callback_type cb) const;
 
+    /** Asynchronously returns a snapshot of the vCPU's state via @a cb.
+     *
+     * Like any other request, this is processed between instructions, so it
+     * can be called whilst the program is running.  The memory is copied, so
+     * taking a snapshot does not affect the vCPU's performance afterwards.
+     * @param cb Called with the snapshot
+     * @exception execution_exception Thrown if backend has been destroyed,
+     * usually as a result of use-after-move
+     */
+    void snapshot(snapshot_callback_type cb) const;
+
+    /** Replaces the vCPU's state with @a snapshot.
+     *
+     * The registers, memory, input queue, and breakpoints are all replaced.
+     * The execution state is unchanged, except that if the program is
+     * waiting-for-input, then it is resumed (as it is by
+     * add_input(std::string)).
+     * @param snapshot vCPU state to restore
+     * @exception execution_exception Thrown if backend has been destroyed,
+     * usually as a result of use-after-move
+     * @exception execution_exception Thrown if the vCPU ha already been
+     * stopped
+     * @exception execution_exception Thrown if @a snapshot's C or D registers
+     * are out of range, or it has more than one breakpoint at an address
+     */
+    void restore(vcpu_snapshot snapshot);
+
     /** Register @a slot to be called when the state signal fires.
      *
      * You can disconnect from the signal using the returned connection
      * instance.
-     * @note @a slot is called from the vCPU's local event loop thread, so you
-     * may need to post into the event loop you intend on processing it with
+     * @note @a slot is called from the vCPU's event loop thread, so you may
+     * need to post into the event loop you intend on processing it with
      * @param slot Callable instance called when the signal fires
      * @return Connection data
      * @exception execution_exception Thrown if backend has been destroyed,
@@ -218,8 +365,8 @@ public:
      *
      * You can disconnect from the signal using the returned connection
      * instance.
-     * @note @a slot is called from the vCPU's local event loop thread, so you
-     * may need to post into the event loop you intend on processing it with
+     * @note @a slot is called from the vCPU's event loop thread, so you may
+     * need to post into the event loop you intend on processing it with
      * @param slot Callable instance called when the signal fires
      * @return Connection data
      * @exception execution_exception Thrown if backend has been destroyed,
@@ -228,12 +375,33 @@ public:
     output_signal_type::connection
     register_for_output_signal(output_signal_type::slot_type slot);
 
+    /** Register @a slot to be called when the buffered output signal fires.
+     *
+     * Unlike register_for_output_signal(output_signal_type::slot_type), output
+     * is collected and delivered in chunks.  The buffer is flushed when it
+     * reaches output_buffer_size characters, when the execution state changes
+     * (including waiting for input), and when the vCPU yields back to its event
+     * loop - so output is never held indefinitely.  Buffered output is always
+     * delivered before the state signal that caused the flush.
+     *
+     * You can disconnect from the signal using the returned connection
+     * instance.
+     * @note @a slot is called from the vCPU's event loop thread, so you may
+     * need to post into the event loop you intend on processing it with
+     * @param slot Callable instance called when the signal fires
+     * @return Connection data
+     * @exception execution_exception Thrown if backend has been destroyed,
+     * usually as a result of use-after-move
+     */
+    buffered_output_signal_type::connection
+    register_for_buffered_output_signal(buffered_output_signal_type::slot_type slot);
+
     /** Register @a slot to be called when the breakpoint hit signal fires.
      *
      * You can disconnect from the signal using the returned connection
      * instance.
-     * @note @a slot is called from the vCPU's local event loop thread, so you
-     * may need to post into the event loop you intend on processing it with
+     * @note @a slot is called from the vCPU's event loop thread, so you may
+     * need to post into the event loop you intend on processing it with
      * @param slot Callable instance called when the signal fires
      * @return Connection data
      * @exception execution_exception Thrown if backend has been destroyed,
@@ -257,6 +425,14 @@ private:
  */
 std::ostream& operator<<(std::ostream& stream, virtual_cpu::vcpu_register register_id);
 
+/** Textual streaming operator for virtual_cpu::engine_type.
+ *
+ * @param stream Output stream
+ * @param engine Instance to stream
+ * @return @a stream
+ */
+std::ostream& operator<<(std::ostream& stream, virtual_cpu::engine_type engine);
+
 /** Textual streaming operator for virtual_cpu::execution_state.
  *
  * @param stream Output stream
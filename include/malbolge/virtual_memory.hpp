@@ -9,23 +9,43 @@
 #include "malbolge/exception.hpp"
 
 #include <array>
-#include <span>
 #include <memory>
+#include <utility>
+#include <vector>
 
 namespace malbolge
 {
 /** Represents the virtual machines memory.
  *
- * This class can not be copied, but can be moved.
+ * Each cell is a math::ternary, which uses math::ternary::storage_type for its
+ * storage - so a fully initialised memory image occupies ~118KB.
+ *
+ * The memory space is split into pages of page_size cells.  clone() creates a
+ * copy that shares the memory image, and only copies a page when it is first
+ * written to (by either instance).  As most of the memory space is never
+ * written to during a run, this makes forking a loaded program for many runs
+ * cheap.
+ *
+ * This class can not be copied (use clone() instead), but can be moved.
  */
 class virtual_memory
 {
-    using base = std::unique_ptr<std::array<math::ternary, math::ternary::max+1>>;
+    using storage = std::array<math::ternary, math::ternary::max+1>;
+
+    // Every cell is written during construction, so the memory is allocated
+    // without value-initialising it first
+    struct deleter
+    {
+        void operator()(storage* mem) const noexcept
+        {
+            std::allocator<storage>{}.deallocate(mem, 1);
+        }
+    };
 
 public:
     /** Memory 'cell' type.
      */
-    using value_type = base::element_type::value_type;
+    using value_type = storage::value_type;
 
     /** Iterator class.
      *
@@ -49,7 +69,7 @@ public:
     class iterator_generic
     {      
     public:
-        using difference_type   = virtual_memory::base::element_type::difference_type;  ///< Difference type
+        using difference_type   = virtual_memory::storage::difference_type;          ///< Difference type
         using value_type        = std::conditional_t<IsConstant,
                                                      const virtual_memory::value_type,
                                                      virtual_memory::value_type>;       ///< Value type
@@ -75,18 +95,18 @@ public:
          * @return A reference to the element the iterator points to
          */
         [[nodiscard]]
-        constexpr reference operator*() const noexcept
+        reference operator*() const noexcept(IsConstant)
         {
-            return *current_;
+            return vmem_->unchecked_at(pos_);
         }
 
         /** Member-of operator for value_type.
          *
          * @return Pointer to the element the iterator points to
          */
-        constexpr pointer operator->() const noexcept
+        pointer operator->() const noexcept(IsConstant)
         {
-            return &(*current_);
+            return &(**this);
         }
 
         /** Pre-increment operator.
@@ -97,7 +117,7 @@ public:
          */
         constexpr iterator_generic& operator++() noexcept
         {
-            current_ = current_ == (data_.end()-1) ? data_.begin() : ++current_;
+            pos_ = pos_ == (vmem_->size()-1) ? 0 : pos_+1;
             return *this;
         }
 
@@ -122,7 +142,7 @@ public:
         [[nodiscard]]
         constexpr auto operator<=>(const iterator_generic& other) const noexcept
         {
-            return current_ <=> other.current_;
+            return pos_ <=> other.pos_;
         }
 
         /** Pre-decrement operator.
@@ -133,7 +153,7 @@ public:
          */
         constexpr iterator_generic& operator--() noexcept
         {
-            current_ = current_ == data_.begin() ? (data_.end()-1) : --current_;
+            pos_ = pos_ == 0 ? (vmem_->size()-1) : pos_-1;
             return *this;
         }
 
@@ -159,25 +179,18 @@ public:
          */
         constexpr iterator_generic& operator+=(difference_type offset) noexcept
         {
+            const auto size = static_cast<difference_type>(vmem_->size());
             const auto positive = offset >= 0;
-            offset = std::abs(offset) % data_.size();
+            offset = std::abs(offset) % size;
+
+            auto pos = static_cast<difference_type>(pos_);
             if (positive) {
-                const auto dist_to_end = std::distance(current_, data_.end());
-                if (offset > dist_to_end) {
-                    offset -= dist_to_end;
-                    current_ = data_.begin() + offset;
-                } else {
-                    current_ += offset;
-                }
+                const auto dist_to_end = size - pos;
+                pos = offset >= dist_to_end ? offset - dist_to_end : pos + offset;
             } else {
-                const auto dist_to_start = std::distance(data_.begin(), current_);
-                if (offset > dist_to_start) {
-                    offset -= dist_to_start;
-                    current_ = data_.end() - offset;
-                } else {
-                    current_ -= offset;
-                }
+                pos = offset > pos ? size - (offset - pos) : pos - offset;
             }
+            pos_ = static_cast<size_type>(pos);
 
             return *this;
         }
@@ -243,35 +256,42 @@ public:
         [[nodiscard]]
         constexpr difference_type operator-(const iterator_generic& other) const noexcept
         {
-            return current_ - other.current_;
+            return static_cast<difference_type>(pos_) -
+                   static_cast<difference_type>(other.pos_);
         }
 
     private:
         friend class virtual_memory;
 
-        using span = std::span<value_type,
-                               std::tuple_size<virtual_memory::base::element_type>::value>;
+        using memory_pointer = std::conditional_t<IsConstant,
+                                                  const virtual_memory*,
+                                                  virtual_memory*>;
 
-        constexpr explicit iterator_generic(span data, bool is_end = false) noexcept :
-            data_{data},
-            current_{is_end ? data.end() : data.begin()}
+        constexpr explicit iterator_generic(memory_pointer vmem,
+                                            bool is_end = false) noexcept :
+            vmem_{vmem},
+            pos_{is_end ? vmem->size() : 0}
         {}
 
-        span data_;
-        typename span::iterator current_;
+        memory_pointer vmem_;
+        virtual_memory::storage::size_type pos_;
     };
 
-    using size_type              = base::element_type::size_type;           ///< Size type
-    using difference_type        = base::element_type::difference_type;     ///< Pointer difference type
-    using reference              = base::element_type::reference;           ///< Reference type
-    using const_reference        = base::element_type::const_reference;     ///< Const reference type
-    using pointer                = base::element_type::pointer;             ///< Pointer type
-    using const_pointer          = base::element_type::const_pointer;       ///< Conts pointer type
+    using size_type              = storage::size_type;                      ///< Size type
+    using difference_type        = storage::difference_type;                ///< Pointer difference type
+    using reference              = storage::reference;                      ///< Reference type
+    using const_reference        = storage::const_reference;                ///< Const reference type
+    using pointer                = storage::pointer;                        ///< Pointer type
+    using const_pointer          = storage::const_pointer;                  ///< Conts pointer type
     using iterator               = iterator_generic<false>;                 ///< Iterator type
     using const_iterator         = iterator_generic<true>;                  ///< Const iterator type
     using reverse_iterator       = std::reverse_iterator<iterator>;         ///< Reverse iterator type
     using const_reverse_iterator = std::reverse_iterator<const_iterator>;   ///< Const reverse iterator type
 
+    /** Number of cells in a copy-on-write page.
+     */
+    static constexpr auto page_size = size_type{729};
+
     /** Constructor.
      *
      * Initialises the virtual memory by loading the program data and then
@@ -287,7 +307,7 @@ public:
      */
     template <typename InputIt>
     explicit virtual_memory(InputIt first, InputIt last) :
-        mem_{std::make_unique<base::element_type>()}
+        image_{std::allocator<storage>{}.allocate(1), deleter{}}
     {
         const auto program_length = std::distance(first, last);
         if (program_length < 2) {
@@ -299,14 +319,47 @@ public:
                                   "math::ternary::max"};
         }
 
-        // Copy the program data in
-        auto op_it = std::copy(first, last, mem_->begin());
+        // Copy the program data in, and fill the remainder of the data space
+        // with the ternary op applied with the previous two addresses
+        std::copy(first, last, image_->begin());
+        fill(static_cast<size_type>(program_length));
+        map_image();
+    }
 
-        // Fill the remainder of the data space with the ternary op applied with
-        // the previous two addresses
-        for (; op_it != mem_->end(); ++op_it) {
-            *op_it = (op_it-1)->op(*(op_it-2));
+    /** Constructor.
+     *
+     * Rather than copying the program data in, @a writer writes it directly
+     * into the start of the memory space.  This saves a copy when the program
+     * data needs transforming (e.g. stripping whitespace) anyway.  The
+     * remainder is then filled as in virtual_memory(InputIt, InputIt).
+     *
+     * @a writer is called with a pointer to the first cell and a pointer to
+     * the one-past-the-end cell, and must return the number of cells written.
+     * @tparam Writer Callable type with the signature
+     * <TT>size_type (pointer, pointer)</TT>
+     * @param writer Program data writer
+     * @exception parse_exception Thrown if program length is less than 2 characters
+     * @exception parse_exception Thrown if program length is greater than
+     * math::ternary::max
+     */
+    template <typename Writer>
+    explicit virtual_memory(std::in_place_t, Writer&& writer) :
+        image_{std::allocator<storage>{}.allocate(1), deleter{}}
+    {
+        const auto program_length = std::forward<Writer>(writer)(
+            image_->data(),
+            image_->data() + image_->size());
+        if (program_length < 2) {
+            throw parse_exception{"Program data must be at least 2 characters"};
         }
+
+        if (program_length > size()) {
+            throw parse_exception{"Program data must be less than "
+                                  "math::ternary::max"};
+        }
+
+        fill(static_cast<size_type>(program_length));
+        map_image();
     }
 
     /** Constructor.
@@ -359,27 +412,59 @@ public:
     virtual_memory(const virtual_memory& other) = delete;
     virtual_memory& operator=(const virtual_memory& other) = delete;
 
+    /** Returns a copy-on-write copy of this instance.
+     *
+     * The clone shares this instance's memory image, any pages already
+     * written to by this instance since it was last cloned are copied.  From
+     * then on, whichever instance first writes to a shared page receives its
+     * own copy of it - so neither instance can see the other's writes.
+     *
+     * The shared memory image is never written to, so clones can be used
+     * concurrently from different threads.  However clone() itself must not
+     * be called concurrently with any other access to this instance.
+     * @return Copy of this instance
+     * @exception std::bad_alloc Thrown if a page copy cannot be allocated
+     */
+    [[nodiscard]]
+    virtual_memory clone();
+
+    /** Returns the number of pages that this instance owns exclusively.
+     *
+     * A newly loaded instance owns its entire memory image, and a new clone
+     * owns none of it.  The private memory used by an instance is roughly
+     * this multiplied by page_size cells.
+     * @return Number of private pages
+     */
+    [[nodiscard]]
+    size_type num_private_pages() const noexcept;
+
     /** Returns a reference to the element at @a pos.
      *
      * If @a pos will exceeds the memory space, it will wrap around.
+     *
+     * If the page containing @a pos is shared with a clone, it is copied
+     * first.  Use the const overloads if the element is only read.
      * @param pos Offset from start of memory space
      * @return Reference to the element at @a pos (or equivalent wrapped)
+     * @exception std::bad_alloc Thrown if a page copy cannot be allocated
      */
     [[nodiscard]]
-    reference operator[](size_type pos) noexcept
+    reference operator[](size_type pos)
     {
-        return iterator{*mem_}[pos];
+        return unchecked_at(pos % size());
     }
 
     /** Ternary overload.
      *
+     * A ternary can never exceed the memory space, so this does not need to
+     * perform any wrapping.
      * @param pos Offset from start of memory space
      * @return Reference to the element at @a pos
      */
     [[nodiscard]]
-    reference operator[](math::ternary pos) noexcept
+    reference operator[](math::ternary pos)
     {
-        return (*this)[static_cast<size_type>(pos)];
+        return unchecked_at(static_cast<size_type>(pos));
     }
 
     /** Const-overload.
@@ -391,29 +476,31 @@ public:
     [[nodiscard]]
     const_reference operator[](size_type pos) const noexcept
     {
-        return const_iterator{*mem_}[pos];
+        return unchecked_at(pos % size());
     }
 
     /** Const ternary overload.
      *
+     * A ternary can never exceed the memory space, so this does not need to
+     * perform any wrapping.
      * @param pos Offset from start of memory space
      * @return Reference to the element at @a pos
      */
     [[nodiscard]]
     const_reference operator[](math::ternary pos) const noexcept
     {
-        return (*this)[static_cast<size_type>(pos)];
+        return unchecked_at(static_cast<size_type>(pos));
     }
 
     /** Returns the element at @a pos.
      *
      * Because this type's iterators wrap, this is the same as
-     * operator[](size_type pos), and will never throw.
+     * operator[](size_type pos), and will never throw an out of range error.
      * @param pos Offset from start of memory space
      * @return Reference to the element at @a pos (or equivalent wrapped)
      */
     [[nodiscard]]
-    reference at(size_type pos) noexcept
+    reference at(size_type pos)
     {
         return (*this)[pos];
     }
@@ -424,9 +511,9 @@ public:
      * @return Reference to the element at @a pos
      */
     [[nodiscard]]
-    reference at(math::ternary pos) noexcept
+    reference at(math::ternary pos)
     {
-        return at(static_cast<size_type>(pos));
+        return (*this)[pos];
     }
 
     /** Const-overload.
@@ -450,7 +537,56 @@ public:
     [[nodiscard]]
     const_reference at(math::ternary pos) const noexcept
     {
-        return at(static_cast<size_type>(pos));
+        return (*this)[pos];
+    }
+
+    /** Returns the element at @a pos without any wrapping.
+     *
+     * This is intended for hot paths where the caller already guarantees that
+     * @a pos is in the range [0, math::ternary::max].
+     * If the page containing @a pos is shared with a clone, it is copied
+     * first.
+     * @warning Behaviour is undefined if @a pos is not less than size()
+     * @param pos Offset from start of memory space
+     * @return Reference to the element at @a pos
+     * @exception std::bad_alloc Thrown if a page copy cannot be allocated
+     */
+    [[nodiscard]]
+    reference unchecked_at(size_type pos)
+    {
+        if (flat_) [[likely]] {
+            return flat_[pos];
+        }
+        return paged_at(pos);
+    }
+
+    /** Const-overload.
+     *
+     * @warning Behaviour is undefined if @a pos is not less than size()
+     * @param pos Offset from start of memory space
+     * @return Reference to the element at @a pos
+     */
+    [[nodiscard]]
+    const_reference unchecked_at(size_type pos) const noexcept
+    {
+        if (flat_) [[likely]] {
+            return flat_[pos];
+        }
+        return paged_at(pos);
+    }
+
+    /** Returns the contiguous memory image, if it is private to this
+     * instance.
+     *
+     * This allows hot loops to skip the page lookup in unchecked_at(size_type),
+     * the pointer is valid until this instance is cloned or destroyed.
+     * @return Pointer to the first cell, or nullptr if this instance has been
+     * cloned or is a clone
+     */
+    [[nodiscard]]
+    pointer flat_data() noexcept
+    {
+        return flat_;
     }
 
     /** A iterator to the beginning of the memory space.
@@ -460,7 +596,7 @@ public:
     [[nodiscard]]
     iterator begin() noexcept
     {
-        return iterator{*mem_};
+        return iterator{this};
     }
 
     /** Const-overload.
@@ -470,7 +606,7 @@ public:
     [[nodiscard]]
     const_iterator begin() const noexcept
     {
-        return const_iterator{*mem_};
+        return const_iterator{this};
     }
 
     /** A const iterator to the beginning of the memory space.
@@ -491,7 +627,7 @@ public:
     [[nodiscard]]
     iterator end() noexcept
     {
-        return iterator{*mem_, true};
+        return iterator{this, true};
     }
 
     /** Const-overload.
@@ -502,7 +638,7 @@ public:
     [[nodiscard]]
     const_iterator end() const noexcept
     {
-        return const_iterator{*mem_, true};
+        return const_iterator{this, true};
     }
 
     /** A const iterator to one-past-the-end of the memory space.
@@ -600,7 +736,7 @@ public:
     [[nodiscard]]
     constexpr size_type size() const noexcept
     {
-        return std::tuple_size<base::element_type>::value;
+        return std::tuple_size<storage>::value;
     }
 
     /** Returns the maximum memory space size.
@@ -616,6 +752,46 @@ public:
     }
 
 private:
-    base mem_;
+    static constexpr auto num_pages = std::tuple_size<storage>::value / page_size;
+    static_assert(num_pages * page_size == std::tuple_size<storage>::value,
+                  "Page size must divide the memory space");
+
+    using page_pointer = std::unique_ptr<value_type[]>;
+
+    // Used by clone()
+    virtual_memory() = default;
+
+    // Fills the memory from @a pos onwards with the ternary op applied to the
+    // previous two cells
+    void fill(size_type pos) noexcept;
+
+    // Maps every page onto the memory image, which is initially private to
+    // this instance
+    void map_image() noexcept;
+
+    // Page lookups for unchecked_at(size_type) once the image is shared, these
+    // are kept out of line so they don't bloat callers' hot loops
+    reference paged_at(size_type pos);
+    const_reference paged_at(size_type pos) const noexcept;
+
+    // Gives this instance its own copy of the page at @a index, returns the
+    // start of the copy
+    pointer make_private(size_type index);
+
+    // Initialised memory image, shared with any clones.  Once cloned, it is
+    // never written to
+    std::shared_ptr<storage> image_;
+
+    // The memory image if it is private to this instance, this allows the
+    // page lookup to be skipped until the first clone
+    pointer flat_ = nullptr;
+
+    // Page copies owned by this instance
+    std::vector<page_pointer> owned_pages_;
+
+    // The start of each page for reading, and for writing.  A null write
+    // page means that the page is shared and must be copied before writing
+    std::array<const_pointer, num_pages> read_pages_;
+    std::array<pointer, num_pages> write_pages_;
 };
 }
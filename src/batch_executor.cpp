@@ -0,0 +1,205 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/batch_executor.hpp"
+#include "malbolge/execute.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+using namespace malbolge;
+
+class batch_executor::impl_t
+{
+public:
+    explicit impl_t(std::size_t num_threads) :
+        queues_(num_threads)
+    {
+        workers_.reserve(num_threads);
+        for (auto i = 0u; i < num_threads; ++i) {
+            workers_.emplace_back([this, i]() { worker(i); });
+        }
+    }
+
+    ~impl_t()
+    {
+        {
+            auto lk = std::lock_guard{mtx_};
+            stop_ = true;
+        }
+        cv_.notify_all();
+
+        for (auto& t : workers_) {
+            t.join();
+        }
+    }
+
+    [[nodiscard]]
+    std::size_t size() const noexcept
+    {
+        return workers_.size();
+    }
+
+    std::vector<result> run(std::vector<job> jobs)
+    {
+        auto results = std::vector<result>(jobs.size());
+        if (jobs.empty()) {
+            return results;
+        }
+
+        auto run_lk = std::lock_guard{run_mtx_};
+        {
+            auto lk = std::lock_guard{mtx_};
+            jobs_ = &jobs;
+            results_ = &results;
+            remaining_ = jobs.size();
+        }
+
+        // Deal the jobs out evenly, the workers will rebalance by stealing.
+        // This must happen after the job data is set, as a worker that is
+        // still draining the queues from a previous run may pick them up
+        for (auto i = 0u; i < jobs.size(); ++i) {
+            auto& q = queues_[i % queues_.size()];
+            auto lk = std::lock_guard{q.mtx};
+            q.jobs.push_back(i);
+        }
+
+        {
+            auto lk = std::unique_lock{mtx_};
+            ++generation_;
+            cv_.notify_all();
+
+            done_cv_.wait(lk, [&]() { return remaining_ == 0; });
+            jobs_ = nullptr;
+            results_ = nullptr;
+        }
+
+        return results;
+    }
+
+private:
+    struct job_queue
+    {
+        std::mutex mtx;
+        std::deque<std::size_t> jobs;
+    };
+
+    void worker(std::size_t id)
+    {
+        auto seen_generation = std::size_t{0};
+        while (true) {
+            {
+                auto lk = std::unique_lock{mtx_};
+                cv_.wait(lk, [&]() {
+                    return stop_ || generation_ != seen_generation;
+                });
+                if (stop_) {
+                    return;
+                }
+                seen_generation = generation_;
+            }
+
+            while (auto i = next_job(id)) {
+                execute((*jobs_)[*i], (*results_)[*i]);
+
+                auto lk = std::lock_guard{mtx_};
+                if (--remaining_ == 0) {
+                    done_cv_.notify_one();
+                }
+            }
+        }
+    }
+
+    // Takes from the front of the worker's own queue, or steals from the back
+    // of another's if empty
+    std::optional<std::size_t> next_job(std::size_t id)
+    {
+        for (auto i = 0u; i < queues_.size(); ++i) {
+            auto& q = queues_[(id + i) % queues_.size()];
+            auto lk = std::lock_guard{q.mtx};
+            if (q.jobs.empty()) {
+                continue;
+            }
+
+            auto job_index = std::size_t{0};
+            if (i == 0) {
+                job_index = q.jobs.front();
+                q.jobs.pop_front();
+            } else {
+                job_index = q.jobs.back();
+                q.jobs.pop_back();
+            }
+            return job_index;
+        }
+
+        return {};
+    }
+
+    static void execute(job& j, result& r)
+    {
+        try {
+            const auto exec_result = malbolge::execute(std::move(j.vmem),
+                                                       j.input,
+                                                       r.output,
+                                                       j.limits);
+            r.steps = exec_result.steps;
+            switch (exec_result.state) {
+            case execution_result::status::WAITING_FOR_INPUT:
+                r.state = virtual_cpu::execution_state::WAITING_FOR_INPUT;
+                break;
+            case execution_result::status::LIMIT_REACHED:
+                r.state = virtual_cpu::execution_state::STOPPED;
+                r.error = std::make_exception_ptr(
+                    limit_exception{*exec_result.limit, exec_result.steps});
+                break;
+            default:
+                r.state = virtual_cpu::execution_state::STOPPED;
+                break;
+            }
+        } catch (execution_exception& e) {
+            r.state = virtual_cpu::execution_state::STOPPED;
+            r.error = std::current_exception();
+            r.steps = e.step();
+        } catch (std::exception&) {
+            // Not a program error (e.g. allocation failure), but it must not
+            // escape the worker thread
+            r.state = virtual_cpu::execution_state::STOPPED;
+            r.error = std::current_exception();
+        }
+    }
+
+    std::mutex run_mtx_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+    std::size_t generation_ = 0;
+    std::size_t remaining_ = 0;
+    bool stop_ = false;
+    std::vector<job>* jobs_ = nullptr;
+    std::vector<result>* results_ = nullptr;
+
+    std::vector<job_queue> queues_;
+    std::vector<std::thread> workers_;
+};
+
+batch_executor::batch_executor(std::size_t num_threads) :
+    impl_{std::make_unique<impl_t>(num_threads ?
+                                   num_threads :
+                                   std::max(std::thread::hardware_concurrency(), 1u))}
+{}
+
+batch_executor::~batch_executor() = default;
+
+std::size_t batch_executor::size() const noexcept
+{
+    return impl_->size();
+}
+
+std::vector<batch_executor::result> batch_executor::run(std::vector<job> jobs)
+{
+    return impl_->run(std::move(jobs));
+}
@@ -28,6 +28,24 @@ static_assert(static_cast<int>(MALBOLGE_VCPU_REGISTER_MAX) ==
                 static_cast<int>(virtual_cpu::vcpu_register::NUM_REGISTERS),
               "malbolge_vcpu_register and virtual_cpu::vcpu_register mismatch");
 
+[[nodiscard]]
+malbolge_result limit_error(limit_exception::limit_type type) noexcept
+{
+    static_assert(static_cast<int>(limit_exception::limit_type::NUM_LIMITS) == 3,
+                  "Number of limit types have changed, update limit_error");
+
+    switch (type) {
+    case limit_exception::limit_type::STEPS:
+        return MALBOLGE_ERR_STEP_LIMIT;
+    case limit_exception::limit_type::DEADLINE:
+        return MALBOLGE_ERR_DEADLINE;
+    case limit_exception::limit_type::OUTPUT:
+        return MALBOLGE_ERR_OUTPUT_LIMIT;
+    default:
+        return MALBOLGE_ERR_EXECUTION_FAIL;
+    }
+}
+
 class vcpu_signal_manager
 {
 public:
@@ -57,6 +75,9 @@ public:
                 if (eptr) {
                     try {
                         std::rethrow_exception(eptr);
+                    } catch (limit_exception& e) {
+                        log::print(log::INFO, e.what());
+                        err = limit_error(e.type());
                     } catch (system_exception& e) {
                         log::print(log::ERROR, e.what());
                         err = static_cast<malbolge_result>(e.code().value());
@@ -447,6 +468,41 @@ int malbolge_vcpu_step(malbolge_virtual_cpu vcpu)
     return err;
 }
 
+int malbolge_vcpu_set_limits(malbolge_virtual_cpu vcpu,
+                             unsigned int max_steps,
+                             unsigned int max_runtime_ms,
+                             unsigned int max_output)
+{
+    if (!vcpu) [[unlikely]] {
+        log::print(log::ERROR, "NULL virtual CPU pointer");
+        return MALBOLGE_ERR_NULL_ARG;
+    }
+
+    try {
+        auto limits = execution_limits{};
+        if (max_steps) {
+            limits.max_steps = max_steps;
+        }
+        if (max_runtime_ms) {
+            limits.deadline = std::chrono::steady_clock::now() +
+                              std::chrono::milliseconds{max_runtime_ms};
+        }
+        if (max_output) {
+            limits.max_output = max_output;
+        }
+
+        auto vcpu_ptr = static_cast<virtual_cpu*>(vcpu);
+        vcpu_ptr->set_limits(std::move(limits));
+        return MALBOLGE_ERR_SUCCESS;
+    } catch (std::exception& e) {
+        log::print(log::ERROR, e.what());
+    } catch (...) {
+        log::print(log::ERROR, "Unknown exception");
+    }
+
+    return MALBOLGE_ERR_UNKNOWN;
+}
+
 int malbolge_vcpu_add_input(malbolge_virtual_cpu vcpu,
                             const char* buffer,
                             unsigned int size)
@@ -648,6 +704,9 @@ int malbolge_vcpu_run_wasm(malbolge_virtual_cpu vcpu)
         if (eptr) {
             try {
                 std::rethrow_exception(eptr);
+            } catch (limit_exception& e) {
+                log::print(log::INFO, e.what());
+                err = limit_error(e.type());
             } catch (system_exception& e) {
                 log::print(log::ERROR, e.what());
                 err = static_cast<malbolge_result>(e.code().value());
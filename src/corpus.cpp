@@ -0,0 +1,205 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/corpus.hpp"
+#include "malbolge/loader.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <thread>
+
+using namespace malbolge;
+using namespace std::string_literals;
+
+namespace
+{
+struct corpus_file
+{
+    std::filesystem::path path;
+    std::filesystem::path relative_path;
+    bool output_collision = false;
+};
+
+[[nodiscard]]
+std::vector<corpus_file> find_files(const std::vector<std::filesystem::path>& dirs)
+{
+    auto files = std::vector<corpus_file>{};
+    for (const auto& dir : dirs) {
+        try {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator{dir}) {
+                if (entry.is_regular_file() && entry.path().extension() == ".mal") {
+                    files.push_back({entry.path(),
+                                     entry.path().lexically_relative(dir)});
+                }
+            }
+        } catch (std::filesystem::filesystem_error& e) {
+            throw system_exception{"Failed to read corpus directory: "s + e.what(),
+                                   e.code().value()};
+        }
+    }
+
+    std::sort(files.begin(), files.end(), [](auto&& a, auto&& b) {
+        return a.path < b.path;
+    });
+    return files;
+}
+
+// Marks every file that shares its output path with another, as the workers
+// would otherwise write to the same file concurrently
+void mark_output_collisions(std::vector<corpus_file>& files)
+{
+    auto by_output = std::vector<corpus_file*>{};
+    by_output.reserve(files.size());
+    for (auto& file : files) {
+        by_output.push_back(&file);
+    }
+    std::sort(by_output.begin(), by_output.end(), [](auto&& a, auto&& b) {
+        return a->relative_path < b->relative_path;
+    });
+
+    for (auto i = 1u; i < by_output.size(); ++i) {
+        if (by_output[i-1]->relative_path == by_output[i]->relative_path) {
+            by_output[i-1]->output_collision = true;
+            by_output[i]->output_collision = true;
+        }
+    }
+}
+
+[[nodiscard]]
+std::string read_file(const std::filesystem::path& path)
+{
+    auto data = std::string(std::filesystem::file_size(path), '\0');
+
+    auto stream = std::ifstream{};
+    stream.exceptions(std::ios::badbit | std::ios::failbit);
+    stream.open(path, std::ios::binary);
+    stream.read(data.data(), static_cast<std::streamsize>(data.size()));
+
+    return data;
+}
+
+void write_file(const std::filesystem::path& path, const std::string& data)
+{
+    std::filesystem::create_directories(path.parent_path());
+
+    auto stream = std::ofstream{};
+    stream.exceptions(std::ios::badbit | std::ios::failbit);
+    stream.open(path, std::ios::binary | std::ios::trunc);
+    stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+void process_file(const corpus_file& file,
+                  corpus_operation op,
+                  const std::optional<std::filesystem::path>& output_dir)
+{
+    if (file.output_collision) {
+        throw system_exception{"Output path shared with another corpus file: " +
+                                   file.relative_path.string(),
+                               std::errc::file_exists};
+    }
+
+    auto data = read_file(file.path);
+
+    switch (op) {
+    case corpus_operation::VALIDATE:
+    {
+        // Loading performs the full validation, including the size checks
+        [[maybe_unused]] const auto vmem = load(data);
+        return;
+    }
+    case corpus_operation::NORMALISE:
+        normalise_source_resize(data);
+        break;
+    case corpus_operation::DENORMALISE:
+        denormalise_source_resize(data);
+        break;
+    default:
+        throw system_exception{"Unknown corpus operation",
+                               std::errc::invalid_argument};
+    }
+
+    write_file(*output_dir / file.relative_path, data);
+}
+}
+
+std::ostream& malbolge::operator<<(std::ostream& stream, corpus_operation op)
+{
+    static_assert(static_cast<int>(corpus_operation::NUM_OPERATIONS) == 3,
+                  "Number of corpus operations have changed, update operator<<");
+
+    switch (op) {
+    case corpus_operation::VALIDATE:
+        return stream << "validate";
+    case corpus_operation::NORMALISE:
+        return stream << "normalise";
+    case corpus_operation::DENORMALISE:
+        return stream << "denormalise";
+    default:
+        return stream << "Unknown corpus operation: " << static_cast<int>(op);
+    }
+}
+
+std::vector<corpus_file_result>
+malbolge::process_corpus(const std::vector<std::filesystem::path>& dirs,
+                         corpus_operation op,
+                         const std::optional<std::filesystem::path>& output_dir,
+                         std::size_t num_threads)
+{
+    if (op != corpus_operation::VALIDATE && !output_dir) {
+        throw system_exception{"Output directory required to "s +
+                                   (op == corpus_operation::NORMALISE ?
+                                        "normalise" :
+                                        "denormalise"),
+                               std::errc::invalid_argument};
+    }
+
+    auto files = find_files(dirs);
+    if (op != corpus_operation::VALIDATE) {
+        mark_output_collisions(files);
+    }
+    log::print(log::INFO, "Processing ", files.size(), " corpus files");
+
+    auto results = std::vector<corpus_file_result>(files.size());
+    if (files.empty()) {
+        return results;
+    }
+
+    if (!num_threads) {
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    num_threads = std::min(num_threads, files.size());
+
+    // The files are all independent, so the workers just claim the next
+    // unprocessed index until there are none left
+    auto next = std::atomic<std::size_t>{0};
+    auto worker = [&]() {
+        for (auto i = next++; i < files.size(); i = next++) {
+            auto& r = results[i];
+            r.path = files[i].path;
+
+            const auto start = std::chrono::steady_clock::now();
+            try {
+                process_file(files[i], op, output_dir);
+            } catch (...) {
+                r.error = std::current_exception();
+            }
+            r.duration = std::chrono::steady_clock::now() - start;
+        }
+    };
+
+    auto workers = std::vector<std::thread>{};
+    workers.reserve(num_threads - 1);
+    for (auto i = 1u; i < num_threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    worker();
+
+    for (auto& t : workers) {
+        t.join();
+    }
+
+    return results;
+}
@@ -13,6 +13,81 @@ constexpr auto pre_cipher = R"(+b(29e*j1VMEKLyC})8&m#~W>qxdRp0wkrUo[D7,XTcA"lI)"
                             R"(.v%{gJh4G\-=O@5`_3i<?Z';FNQuY]szf$!BS/|t:Pn6^Ha)";
 constexpr auto post_cipher = R"(5z]&gqtyfr$(we4{WP)H-Zn,[%\3dL+Q;>U!pJS72FhOA1C)"
                              R"(B6v^=I_0/8|jsb9m<.TVac`uY*MK'X~xDl}REokN:#?G"i@)";
+
+constexpr cpu_instruction::opcode to_opcode(char c) noexcept
+{
+    for (auto i = 0u; i < cpu_instruction::all.size(); ++i) {
+        if (cpu_instruction::all[i] == c) {
+            return static_cast<cpu_instruction::opcode>(i);
+        }
+    }
+    return cpu_instruction::opcode::unknown;
+}
+
+// The pre-cipher index is (input - 33 + index) % 94, so rather than storing
+// pre-cipher characters we store the opcodes they decode to, for every
+// input/index combination
+constexpr auto make_pre_table() noexcept
+{
+    constexpr auto size = std::size_t{cipher::size};
+
+    auto table = std::array<std::array<cpu_instruction::opcode, size>, size>{};
+    for (auto input = 0u; input < size; ++input) {
+        for (auto index = 0u; index < size; ++index) {
+            table[input][index] = to_opcode(pre_cipher[(input + index) % size]);
+        }
+    }
+
+    return table;
+}
+
+constexpr auto make_post_table() noexcept
+{
+    auto table = std::array<char, cipher::size>{};
+    for (auto i = 0u; i < table.size(); ++i) {
+        table[i] = post_cipher[i];
+    }
+
+    return table;
+}
+
+constexpr auto make_transition_table() noexcept
+{
+    constexpr auto size = std::size_t{cipher::size};
+    constexpr auto pre_table = make_pre_table();
+
+    auto table = std::array<std::array<cipher::transition, size>, size>{};
+    for (auto input = 0u; input < size; ++input) {
+        for (auto index = 0u; index < size; ++index) {
+            table[input][index] = {pre_table[input][index], post_cipher[input]};
+        }
+    }
+
+    return table;
+}
+}
+
+const decltype(cipher::pre_table) cipher::pre_table = make_pre_table();
+const decltype(cipher::post_table) cipher::post_table = make_post_table();
+const decltype(cipher::transition_table) cipher::transition_table =
+    make_transition_table();
+
+std::ostream& cpu_instruction::operator<<(std::ostream& stream, opcode code)
+{
+    static_assert(static_cast<std::size_t>(opcode::unknown) == all.size(),
+                  "Opcodes out of sync with CPU instructions, update opcode");
+
+    switch (code) {
+    case opcode::unknown:
+        return stream << "unknown";
+    case opcode::invalid:
+        return stream << "invalid";
+    default:
+        if (static_cast<std::size_t>(code) < all.size()) {
+            return stream << static_cast<char>(to_type(code));
+        }
+        return stream << "Unknown opcode: " << static_cast<int>(code);
+    }
 }
 
 std::optional<char> cipher::pre(std::size_t index) noexcept
@@ -9,7 +9,6 @@
 
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/executor_work_guard.hpp>
-#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/post.hpp>
 
 using namespace malbolge;
@@ -17,6 +16,18 @@ using namespace debugger;
 
 namespace
 {
+[[nodiscard]]
+bool is_runtime_timeout(std::exception_ptr eptr)
+{
+    try {
+        std::rethrow_exception(eptr);
+    } catch (limit_exception& e) {
+        return e.type() == limit_exception::limit_type::DEADLINE;
+    } catch (...) {
+        return false;
+    }
+}
+
 void validate_sequence(const script::functions::sequence& fn_seq)
 {
     // Check that:
@@ -92,7 +103,6 @@ void script::script_runner::run(virtual_memory vmem,
 
     auto ctx = boost::asio::io_context{};
     auto work_guard = boost::asio::executor_work_guard{ctx.get_executor()};
-    auto run_timer = boost::asio::steady_timer{ctx};
 
     // Instantiate the vCPU and hook up the signals
     auto vcpu = std::make_unique<virtual_cpu>(std::move(vmem));
@@ -117,13 +127,10 @@ void script::script_runner::run(virtual_memory vmem,
                 [&](const functions::run& fn) {
                     const auto runtime = fn.value<MAL_STR(max_runtime_ms)>();
                     if (runtime) {
-                        run_timer.expires_after(std::chrono::milliseconds{runtime});
-                        run_timer.async_wait([&](auto ec) {
-                            if (!ec) {
-                                log::print(log::DEBUG, "Script runtime timeout reached");
-                                vcpu.reset();
-                            }
-                        });
+                        auto limits = execution_limits{};
+                        limits.deadline = std::chrono::steady_clock::now() +
+                                          std::chrono::milliseconds{runtime};
+                        vcpu->set_limits(std::move(limits));
                     }
 
                     vcpu->run();
@@ -159,16 +166,19 @@ void script::script_runner::run(virtual_memory vmem,
         output_sig_(c);
     });
     vcpu->register_for_breakpoint_hit_signal([&](auto) {
-        // We've hit a breakpoint so cancel the max runtime timer.  This is a
-        // no-op if the timer is not running
-        run_timer.cancel();
+        // We've hit a breakpoint so clear the max runtime deadline.  This is
+        // harmless if there wasn't one
+        vcpu->set_limits({});
 
         // Continue the function sequence.  We post here because this slot is
         // called from the vCPU's worker thread
         boost::asio::post(ctx, [&]() { run_seq(); });
     });
     vcpu->register_for_state_signal([&](auto state, auto eptr) {
-        if (eptr) {
+        if (eptr && is_runtime_timeout(eptr)) {
+            // The timeout ends the script as if the program had stopped
+            log::print<log::DEBUG>("Script runtime timeout reached");
+        } else if (eptr) {
             // Rethrow the exception from the caller's thread
             boost::asio::post(ctx, [eptr]() {
                 std::rethrow_exception(eptr);
@@ -180,7 +190,6 @@ void script::script_runner::run(virtual_memory vmem,
             // If the vCPU has stopped, we need to stop too.  We do not call
             // ctx.stop() as all queued jobs need processing, specifically
             // errors
-            run_timer.cancel();
             work_guard.reset();
         }
     });
@@ -5,6 +5,8 @@
 
 #include "malbolge/exception.hpp"
 
+#include <sstream>
+
 using namespace malbolge;
 using namespace std::string_literals;
 
@@ -14,6 +16,13 @@ std::error_code to_ec(int ec)
 {
     return std::error_code{ec, std::system_category()};
 }
+
+std::string limit_message(limit_exception::limit_type type)
+{
+    auto ss = std::stringstream{};
+    ss << type << " limit reached";
+    return ss.str();
+}
 }
 
 std::string malbolge::to_string(const optional_source_location& loc)
@@ -40,6 +49,11 @@ execution_exception::execution_exception(const std::string& msg,
     step_{execution_step}
 {}
 
+limit_exception::limit_exception(limit_type type, std::size_t execution_step) :
+    execution_exception{limit_message(type), execution_step},
+    type_{type}
+{}
+
 system_exception::system_exception(const std::string& msg, int error_code) :
     basic_exception{"System error: " + to_ec(error_code).message() + " - " +
                     msg},
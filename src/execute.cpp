@@ -0,0 +1,44 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/execute.hpp"
+
+using namespace malbolge;
+
+std::ostream& malbolge::operator<<(std::ostream& stream,
+                                   execution_result::status status)
+{
+    static_assert(static_cast<int>(execution_result::status::NUM_STATUSES) == 3,
+                  "Number of execution statuses have changed, update operator<<");
+
+    switch (status) {
+    case execution_result::status::STOPPED:
+        return stream << "STOPPED";
+    case execution_result::status::WAITING_FOR_INPUT:
+        return stream << "WAITING_FOR_INPUT";
+    case execution_result::status::LIMIT_REACHED:
+        return stream << "LIMIT_REACHED";
+    default:
+        return stream << "Unknown execution status: " << static_cast<int>(status);
+    }
+}
+
+std::ostream& malbolge::operator<<(std::ostream& stream,
+                                   execution_limits::limit_type type)
+{
+    static_assert(static_cast<int>(execution_limits::limit_type::NUM_LIMITS) == 3,
+                  "Number of limit types have changed, update operator<<");
+
+    switch (type) {
+    case execution_limits::limit_type::STEPS:
+        return stream << "STEPS";
+    case execution_limits::limit_type::OUTPUT:
+        return stream << "OUTPUT";
+    case execution_limits::limit_type::DEADLINE:
+        return stream << "DEADLINE";
+    default:
+        return stream << "Unknown limit type: " << static_cast<int>(type);
+    }
+}
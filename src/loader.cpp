@@ -5,18 +5,14 @@
 
 #include "malbolge/loader.hpp"
 
+#include <array>
 #include <fstream>
-#include <iterator>
+#include <optional>
 #include <vector>
 
 using namespace malbolge;
 using namespace std::string_literals;
 
-namespace
-{
-using stream_iterator = std::istreambuf_iterator<char>;
-}
-
 std::ostream& malbolge::operator<<(std::ostream& stream,
                                    load_normalised_mode mode)
 {
@@ -38,29 +34,43 @@ virtual_memory malbolge::load(const std::filesystem::path& path,
     log::print(log::INFO, "Loading file: ", path);
 
     try {
-        // Unfortunately we cannot pass the istreambuf_iterators directly to
-        // load_impl, as a range requires a ForwardIterator whilst
-        // istreambuf_iterator is only an InputIterator.  So we have to load
-        // into an intermediary buffer first
+        // Read the whole file in one go, rather than through a per-character
+        // stream iterator
         const auto file_size = std::filesystem::file_size(path);
-        log::print(log::DEBUG, "File size: ", file_size);
-
-        auto data = std::vector<char>{};
-        data.reserve(file_size);
+        log::print<log::DEBUG>("File size: ", file_size);
 
+        auto data = std::vector<char>(file_size);
         {
             auto stream = std::ifstream{};
             stream.exceptions(std::ios::badbit | std::ios::failbit);
             stream.open(path, std::ios::binary);
-
-            std::copy(stream_iterator{stream},
-                      stream_iterator{},
-                      std::back_inserter(data));
+            stream.read(data.data(), static_cast<std::streamsize>(data.size()));
         }
 
         log::print(log::INFO, "File loaded");
 
-        return load(data.begin(), data.end(), mode);
+        if (mode == load_normalised_mode::AUTO) {
+            mode = is_likely_normalised_source(data.begin(), data.end()) ?
+                load_normalised_mode::ON :
+                load_normalised_mode::OFF;
+        }
+
+        // The validated program can never be larger than the file, so if the
+        // file fits in the memory space the program can be validated and
+        // stripped straight into it
+        if (mode == load_normalised_mode::ON ||
+            file_size > (math::ternary::max + 1u)) {
+            return load(data.begin(), data.end(), mode);
+        }
+
+        return virtual_memory(std::in_place, [&](auto first, auto) {
+            const auto last = detail::source_validator{}(data.begin(),
+                                                         data.end(),
+                                                         first);
+            const auto size = static_cast<std::size_t>(last - first);
+            log::print<log::DEBUG>("Loaded size: ", size);
+            return size;
+        });
     } catch (parse_exception& e) {
         throw;
     } catch (std::exception& e) {
@@ -68,16 +78,152 @@ virtual_memory malbolge::load(const std::filesystem::path& path,
     }
 }
 
-virtual_memory malbolge::load_from_cin(load_normalised_mode mode)
+virtual_memory malbolge::load_from_stream(std::istream& stream,
+                                          load_normalised_mode mode)
 {
-    log::print(log::INFO, "Loading file from stdin");
+    // The stream is read in fixed size chunks, which are validated and
+    // stripped of whitespace into a buffer that is never larger than the
+    // memory space (plus one chunk).  The buffer is not reserved up front, as
+    // allocating the maximum is much slower for typical small programs than a
+    // few reallocations for large ones
+    constexpr auto chunk_size = std::size_t{4096};
+    constexpr auto max_program_size = std::size_t{math::ternary::max + 1u};
+
+    auto chunk = std::array<char, chunk_size>{};
+    auto program = std::vector<char>{};
+    program.reserve(chunk_size);
+
+    // In AUTO mode, validation for a non-normalised program runs alongside
+    // the normalised check.  If validation fails, but the program could still
+    // be normalised, then the error is deferred until the end
+    auto validator = detail::source_validator{};
+    auto validating = mode != load_normalised_mode::ON;
+    auto could_be_normalised = mode != load_normalised_mode::OFF;
+    auto validation_error = std::exception_ptr{};
+
+    // In ON mode, the first character that rules out a normalised program is
+    // reported like denormalise_source(InputIt, InputIt) would.  This is the
+    // start of any whitespace run, as it is only valid at the end
+    auto stream_offset = std::size_t{0};
+    auto whitespace_offset = std::optional<std::size_t>{};
+    auto whitespace_char = char{};
+    auto not_normalised = [&](std::size_t offset, char c) {
+        if (mode != load_normalised_mode::ON) {
+            return;
+        }
+
+        throw parse_exception{"Invalid instruction in program: " +
+                                  std::to_string(static_cast<int>(c)),
+                              source_location{
+                                  1,
+                                  static_cast<math::ternary::underlying_type>(offset+1)
+                              }};
+    };
+
+    // The validator stops tracking the location once it fails, so the start
+    // of each chunk is tracked separately for the too-long error
+    auto chunk_loc = source_location{};
+    auto advance = [](source_location& loc, auto first, auto last) {
+        for (; first != last; ++first) {
+            if (*first == '\n') {
+                ++loc.line;
+                loc.column = 1;
+            } else {
+                ++loc.column;
+            }
+        }
+    };
+
+    auto strip_copy = [&](auto first, auto last) {
+        std::copy_if(first, last, std::back_inserter(program), [](auto c) {
+            return !detail::is_space(c);
+        });
+    };
+
+    while (stream) {
+        stream.read(chunk.data(), chunk.size());
+        const auto first = chunk.begin();
+        const auto last = first + stream.gcount();
+
+        if (could_be_normalised) {
+            // Normalised programs may only end in whitespace, so whitespace
+            // followed by anything else rules it out
+            for (auto it = first; it != last; ++it) {
+                const auto offset = stream_offset +
+                                    static_cast<std::size_t>(it - first);
+                if (detail::is_space(*it)) {
+                    if (!whitespace_offset) {
+                        whitespace_offset = offset;
+                        whitespace_char = *it;
+                    }
+                } else if (whitespace_offset) {
+                    could_be_normalised = false;
+                    not_normalised(*whitespace_offset, whitespace_char);
+                    break;
+                } else if (!is_cpu_instruction(*it)) {
+                    could_be_normalised = false;
+                    not_normalised(offset, *it);
+                    break;
+                }
+            }
+        }
+        stream_offset += static_cast<std::size_t>(last - first);
+
+        const auto chunk_start = program.size();
+        if (validating) {
+            try {
+                validator(first, last, std::back_inserter(program));
+            } catch (parse_exception&) {
+                if (!could_be_normalised) {
+                    throw;
+                }
+
+                validating = false;
+                validation_error = std::current_exception();
+                program.resize(chunk_start);
+                strip_copy(first, last);
+            }
+        } else {
+            strip_copy(first, last);
+        }
+
+        if (!could_be_normalised && validation_error) {
+            std::rethrow_exception(validation_error);
+        }
+
+        if (program.size() > max_program_size) {
+            // Find the character that took the program over the limit
+            auto it = first;
+            for (auto n = max_program_size - chunk_start; ; ++it) {
+                if (!detail::is_space(*it) && n-- == 0) {
+                    break;
+                }
+            }
+            advance(chunk_loc, first, it);
+
+            throw parse_exception{"Program data must be less than "
+                                  "math::ternary::max",
+                                  chunk_loc};
+        }
+        advance(chunk_loc, first, last);
+    }
 
-    auto program_data = ""s;
-    for (auto line = ""s; std::getline(std::cin, line); ) {
-        program_data += line;
+    if (stream.bad()) {
+        throw parse_exception{"Failed to read program from stream"};
     }
 
     log::print(log::INFO, "File loaded");
 
-    return load(std::begin(program_data), std::end(program_data), mode);
+    if (could_be_normalised) {
+        return load(program.begin(), program.end(), load_normalised_mode::ON);
+    }
+
+    log::print<log::DEBUG>("Loaded size: ", program.size());
+    return virtual_memory(program);
+}
+
+virtual_memory malbolge::load_from_cin(load_normalised_mode mode)
+{
+    log::print(log::INFO, "Loading file from stdin");
+    return load_from_stream(std::cin, mode);
 }
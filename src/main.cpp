@@ -16,6 +16,7 @@
 #include <boost/asio/buffer.hpp>
 #include <boost/core/ignore_unused.hpp>
 
+#include <iomanip>
 #include <iostream>
 #include <optional>
 
@@ -52,6 +53,11 @@ void output_handler(char c)
     std::cout << c << std::flush;
 }
 
+void output_handler(std::string_view str)
+{
+    std::cout << str << std::flush;
+}
+
 void input_handler(virtual_cpu& vcpu,
                    boost::asio::posix::stream_descriptor& cin_stream,
                    std::string& buf,
@@ -103,7 +109,9 @@ void run_program(virtual_memory vmem)
     auto worker_guard = boost::asio::executor_work_guard{ctx.get_executor()};
     auto vcpu = std::make_unique<virtual_cpu>(std::move(vmem));
 
-    vcpu->register_for_output_signal([](auto c) { output_handler(c); });
+    vcpu->register_for_buffered_output_signal([](auto str) {
+        output_handler(str);
+    });
     vcpu->register_for_state_signal([&](auto state, auto eptr) {
         if (eptr) {
             // Rethrow the exception from the caller's thread
@@ -137,6 +145,48 @@ void run_program(virtual_memory vmem)
     ctx.run();
 }
 
+[[nodiscard]]
+int run_corpus(const argument_parser::corpus_data& corpus)
+{
+    using namespace std::chrono;
+
+    const auto start = steady_clock::now();
+    const auto results = process_corpus(corpus.dirs, corpus.op, corpus.output_dir);
+    const auto wall_time = steady_clock::now() - start;
+
+    // Per-file summary, the errors go alongside their file rather than into
+    // the log so that the output can be post-processed
+    auto failures = std::size_t{0};
+    auto file_time = nanoseconds{0};
+    for (const auto& r : results) {
+        file_time += r.duration;
+        std::cout << r.path.string() << '\t'
+                  << duration_cast<microseconds>(r.duration).count() << "us\t";
+        if (r.error) {
+            ++failures;
+            try {
+                std::rethrow_exception(r.error);
+            } catch (std::exception& e) {
+                std::cout << "FAILED: " << e.what();
+            } catch (...) {
+                std::cout << "FAILED: Unknown exception";
+            }
+        } else {
+            std::cout << "OK";
+        }
+        std::cout << '\n';
+    }
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "\n" << corpus.op << ": " << results.size() << " files, "
+              << failures << " failed\n"
+              << "Wall time: " << duration<double>{wall_time}.count() << "s, "
+              << "total file time: " << duration<double>{file_time}.count() << "s"
+              << std::endl;
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
 void run(argument_parser& parser, virtual_memory vmem)
 {
     auto script_path = parser.debugger_script();
@@ -165,6 +215,18 @@ int main(int argc, char* argv[])
         }
 
         log::set_log_level(arg_parser.log_level());
+        if (arg_parser.log_level() < log::log_level_floor) {
+            // log::print(...) would filter this out in exactly the builds that
+            // need it, as the level is checked against the floor too
+            log::basic_print(std::clog,
+                             log::detail::log_level_to_colour(log::INFO),
+                             "[", log::INFO, "]: Log levels below ",
+                             log::log_level_floor, " have been compiled out");
+        }
+
+        if (arg_parser.corpus()) {
+            return run_corpus(*arg_parser.corpus());
+        }
 
         auto vmem = load_program(arg_parser);
         run(arg_parser, std::move(vmem));
@@ -5,6 +5,8 @@
 
 #include "malbolge/math/ternary.hpp"
 
+#include <array>
+
 using namespace malbolge;
 
 namespace
@@ -14,25 +16,111 @@ constexpr auto op_cipher = std::array{
     std::array<std::uint8_t, math::trit::base>{0u, 0u, 2u},
     std::array<std::uint8_t, math::trit::base>{0u, 2u, 1u},
 };
+
+// The op table operates on 5 trit 'halves' of a ternary, this keeps the table
+// small (59049 bytes) whilst still only needing two lookups per op.  Plain
+// arithmetic is used to generate it rather than tritset, as the latter exceeds
+// the compiler's constexpr evaluation limits
+constexpr auto half_width = math::ternary::tritset_type::width / 2;
+constexpr auto half_size = math::ipow<std::size_t, math::trit::base, half_width>();
+
+constexpr auto op_table = []() {
+    auto table = std::array<std::array<std::uint8_t, half_size>, half_size>{};
+    for (auto a = 0u; a < half_size; ++a) {
+        for (auto b = 0u; b < half_size; ++b) {
+            auto a_trits = a;
+            auto b_trits = b;
+            auto result = 0u;
+            auto p = 1u;
+            for (auto i = 0u; i < half_width; ++i) {
+                result += op_cipher[a_trits % math::trit::base]
+                                   [b_trits % math::trit::base] * p;
+                a_trits /= math::trit::base;
+                b_trits /= math::trit::base;
+                p *= math::trit::base;
+            }
+            table[a][b] = static_cast<std::uint8_t>(result);
+        }
+    }
+
+    return table;
+}();
+
+constexpr auto pow3_table = []() {
+    auto table = std::array<math::ternary::underlying_type,
+                            math::ternary::tritset_type::width + 1>{};
+    table[0] = 1;
+    for (auto i = 1u; i < table.size(); ++i) {
+        table[i] = table[i-1] * math::trit::base;
+    }
+
+    return table;
+}();
 }
 
+template <math::ternary::backend B>
 math::ternary& math::ternary::rotate(std::size_t i) noexcept
 {
-    v_ = to_tritset().rotate(i).to_base10();
+    if constexpr (B == backend::TABLE) {
+        constexpr auto width = tritset_type::width;
+
+        // Rotating by one is by far the most common case (it is the only one
+        // the vCPU uses), so let the compiler use constant divisors for it
+        const auto v = underlying_type{v_};
+        i %= width;
+        if (i == 1) {
+            v_ = static_cast<storage_type>((v / trit::base) +
+                                           ((v % trit::base) * pow3_table[width - 1]));
+        } else {
+            v_ = static_cast<storage_type>((v / pow3_table[i]) +
+                                           ((v % pow3_table[i]) * pow3_table[width - i]));
+        }
+    } else {
+        v_ = static_cast<storage_type>(to_tritset().rotate(i).to_base10());
+    }
+
     return *this;
 }
 
+template <math::ternary::backend B>
 math::ternary math::ternary::op(const math::ternary& other) const noexcept
 {
-    const auto a = to_tritset();
-    const auto b = other.to_tritset();
+    if constexpr (B == backend::TABLE) {
+        const auto low = op_table[v_ % half_size][other.v_ % half_size];
+        const auto high = op_table[v_ / half_size][other.v_ / half_size];
+
+        return (high * static_cast<underlying_type>(half_size)) + low;
+    } else {
+        const auto a = to_tritset();
+        const auto b = other.to_tritset();
 
-    auto result = tritset_type{};
-    for (auto i = 0u; i < tritset_type::width; ++i) {
-        result.set(i, op_cipher[a[i]][b[i]]);
+        auto result = tritset_type{};
+        for (auto i = 0u; i < tritset_type::width; ++i) {
+            result.set(i, op_cipher[a[i]][b[i]]);
+        }
+
+        return result.to_base10();
     }
+}
 
-    return result.to_base10();
+template math::ternary& math::ternary::rotate<math::ternary::backend::TRITWISE>(std::size_t) noexcept;
+template math::ternary& math::ternary::rotate<math::ternary::backend::TABLE>(std::size_t) noexcept;
+template math::ternary math::ternary::op<math::ternary::backend::TRITWISE>(const math::ternary&) const noexcept;
+template math::ternary math::ternary::op<math::ternary::backend::TABLE>(const math::ternary&) const noexcept;
+
+std::ostream& math::operator<<(std::ostream& stream, ternary::backend b)
+{
+    static_assert(static_cast<int>(ternary::backend::NUM_BACKENDS) == 2,
+                  "Number of backends have changed, update operator<<");
+
+    switch (b) {
+    case ternary::backend::TRITWISE:
+        return stream << "TRITWISE";
+    case ternary::backend::TABLE:
+        return stream << "TABLE";
+    default:
+        return stream << "Unknown ternary backend: " << static_cast<int>(b);
+    }
 }
 
 std::ostream& std::operator<<(std::ostream& stream,
@@ -0,0 +1,449 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/normalise.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+    !defined(EMSCRIPTEN)
+#define MALBOLGE_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+using namespace malbolge;
+
+namespace
+{
+[[nodiscard]]
+detail::simd_level detect_simd_level() noexcept
+{
+#ifdef MALBOLGE_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return detail::simd_level::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return detail::simd_level::SSE4_2;
+    }
+#endif
+    return detail::simd_level::NONE;
+}
+
+[[nodiscard]]
+std::atomic<detail::simd_level>& current_simd_level() noexcept
+{
+    static auto level = std::atomic<detail::simd_level>{detail::max_simd_level()};
+    return level;
+}
+
+#ifdef MALBOLGE_X86_KERNELS
+// The pre-cipher index that decodes to each instruction, in
+// cpu_instruction::all order
+[[nodiscard]]
+const std::array<char, cpu_instruction::all.size()>& instruction_pre_index() noexcept
+{
+    static const auto table = []() {
+        auto table = std::array<char, cpu_instruction::all.size()>{};
+        for (auto i = 0u; i < cipher::size; ++i) {
+            const auto c = *cipher::pre(i);
+            for (auto j = 0u; j < table.size(); ++j) {
+                if (cpu_instruction::all[j] == c) {
+                    table[j] = static_cast<char>(i);
+                }
+            }
+        }
+        return table;
+    }();
+    return table;
+}
+
+// Normalises up to the source character at last one at a time.  Returns false
+// if a character needs a diagnostic, leaving progress at it
+bool normalise_scalar(char* data,
+                      std::size_t last,
+                      detail::normalise_progress& progress) noexcept
+{
+    auto& [read, written, loc] = progress;
+    for (; read < last; ++read) {
+        const auto c = data[read];
+        if (detail::is_space(c)) {
+            if (c == '\n') {
+                ++loc.line;
+                loc.column = 1;
+            } else {
+                ++loc.column;
+            }
+            continue;
+        }
+
+        const auto instr = pre_cipher_decode(c, written);
+        if (instr >= cpu_instruction::opcode::unknown) [[unlikely]] {
+            return false;
+        }
+
+        data[written++] = cpu_instruction::to_type(instr);
+        ++loc.column;
+    }
+
+    return true;
+}
+
+// The SSE4.2 and AVX2 kernels are identical apart from the vector width, but
+// the intrinsics can't be shared without enabling the instruction set for the
+// whole file
+namespace sse4_2
+{
+constexpr auto lanes = std::size_t{16};
+
+// x % cipher::size, for x < 2 * cipher::size
+[[gnu::target("sse4.2")]]
+__m128i wrap_cipher(__m128i x) noexcept
+{
+    const auto size = _mm_set1_epi8(cipher::size);
+    const auto ge = _mm_cmpeq_epi8(_mm_max_epu8(x, size), x);
+    return _mm_sub_epi8(x, _mm_and_si128(ge, size));
+}
+
+// (position + lane) % cipher::size for each lane
+[[gnu::target("sse4.2")]]
+__m128i lane_offsets(std::size_t position) noexcept
+{
+    const auto iota = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                    8, 9, 10, 11, 12, 13, 14, 15);
+    const auto base = static_cast<char>(position % cipher::size);
+    return wrap_cipher(_mm_add_epi8(_mm_set1_epi8(base), iota));
+}
+
+[[gnu::target("sse4.2")]]
+__m128i load(const char* data) noexcept
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+[[gnu::target("sse4.2")]]
+bool all_set(__m128i mask) noexcept
+{
+    return _mm_movemask_epi8(mask) == 0xFFFF;
+}
+
+[[gnu::target("sse4.2")]]
+std::size_t instruction_prefix(const char* data, std::size_t size) noexcept
+{
+    const auto set = _mm_setr_epi8(cpu_instruction::all[0],
+                                   cpu_instruction::all[1],
+                                   cpu_instruction::all[2],
+                                   cpu_instruction::all[3],
+                                   cpu_instruction::all[4],
+                                   cpu_instruction::all[5],
+                                   cpu_instruction::all[6],
+                                   cpu_instruction::all[7],
+                                   0, 0, 0, 0, 0, 0, 0, 0);
+    static_assert(cpu_instruction::all.size() == 8,
+                  "CPU instruction list changed without updating the SSE4.2 set");
+
+    auto i = std::size_t{0};
+    for (; i + lanes <= size; i += lanes) {
+        // Index of the first character not in the set, or lanes if none
+        const auto first_other = _mm_cmpestri(set,
+                                              cpu_instruction::all.size(),
+                                              load(data + i),
+                                              lanes,
+                                              _SIDD_UBYTE_OPS |
+                                              _SIDD_CMP_EQUAL_ANY |
+                                              _SIDD_MASKED_NEGATIVE_POLARITY);
+        if (first_other != lanes) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+[[gnu::target("sse4.2")]]
+std::size_t denormalise_prefix(char* data, std::size_t size) noexcept
+{
+    auto i = std::size_t{0};
+    for (; i + lanes <= size; i += lanes) {
+        const auto v = load(data + i);
+
+        auto matched = _mm_setzero_si128();
+        auto mapped = _mm_setzero_si128();
+        for (auto instr : cpu_instruction::all) {
+            const auto m = _mm_cmpeq_epi8(v, _mm_set1_epi8(instr));
+            matched = _mm_or_si128(matched, m);
+            mapped = _mm_or_si128(mapped, _mm_and_si128(
+                m,
+                _mm_set1_epi8(detail::char_lookup(detail::denormalise_map, instr))));
+        }
+        if (!all_set(matched)) {
+            break;
+        }
+
+        auto sub = _mm_sub_epi8(mapped, lane_offsets(i));
+        const auto low = _mm_cmpgt_epi8(_mm_set1_epi8(graphical_ascii_range.first),
+                                        sub);
+        sub = _mm_add_epi8(sub, _mm_and_si128(low, _mm_set1_epi8(cipher::size)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), sub);
+    }
+
+    return i;
+}
+
+[[gnu::target("sse4.2")]]
+detail::normalise_progress normalise_prefix(char* data, std::size_t size) noexcept
+{
+    const auto& pre_index = instruction_pre_index();
+    auto progress = detail::normalise_progress{};
+    while (progress.read + lanes <= size) {
+        // Non-graphical characters (including whitespace) are out of range
+        const auto x = _mm_sub_epi8(load(data + progress.read),
+                                    _mm_set1_epi8(graphical_ascii_range.first));
+        const auto graphical = _mm_cmpeq_epi8(
+            _mm_min_epu8(x, _mm_set1_epi8(cipher::size - 1)),
+            x);
+
+        if (all_set(graphical)) {
+            const auto index = wrap_cipher(_mm_add_epi8(
+                x,
+                lane_offsets(progress.written)));
+
+            auto matched = _mm_setzero_si128();
+            auto out = _mm_setzero_si128();
+            for (auto i = 0u; i < cpu_instruction::all.size(); ++i) {
+                const auto m = _mm_cmpeq_epi8(
+                    index,
+                    _mm_set1_epi8(pre_index[i]));
+                matched = _mm_or_si128(matched, m);
+                out = _mm_or_si128(out, _mm_and_si128(
+                    m,
+                    _mm_set1_epi8(cpu_instruction::all[i])));
+            }
+
+            if (all_set(matched)) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(data + progress.written),
+                                 out);
+                progress.read += lanes;
+                progress.written += lanes;
+                progress.loc.column += lanes;
+                continue;
+            }
+        }
+
+        // Whitespace, or a character that needs a diagnostic
+        if (!normalise_scalar(data, progress.read + lanes, progress)) {
+            break;
+        }
+    }
+
+    return progress;
+}
+}
+
+namespace avx2
+{
+constexpr auto lanes = std::size_t{32};
+
+// x % cipher::size, for x < 2 * cipher::size
+[[gnu::target("avx2")]]
+__m256i wrap_cipher(__m256i x) noexcept
+{
+    const auto size = _mm256_set1_epi8(cipher::size);
+    const auto ge = _mm256_cmpeq_epi8(_mm256_max_epu8(x, size), x);
+    return _mm256_sub_epi8(x, _mm256_and_si256(ge, size));
+}
+
+// (position + lane) % cipher::size for each lane
+[[gnu::target("avx2")]]
+__m256i lane_offsets(std::size_t position) noexcept
+{
+    const auto iota = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                       8, 9, 10, 11, 12, 13, 14, 15,
+                                       16, 17, 18, 19, 20, 21, 22, 23,
+                                       24, 25, 26, 27, 28, 29, 30, 31);
+    const auto base = static_cast<char>(position % cipher::size);
+    return wrap_cipher(_mm256_add_epi8(_mm256_set1_epi8(base), iota));
+}
+
+[[gnu::target("avx2")]]
+__m256i load(const char* data) noexcept
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+}
+
+[[gnu::target("avx2")]]
+bool all_set(__m256i mask) noexcept
+{
+    return _mm256_movemask_epi8(mask) == -1;
+}
+
+[[gnu::target("avx2")]]
+__m256i instruction_mask(__m256i v) noexcept
+{
+    auto matched = _mm256_setzero_si256();
+    for (auto instr : cpu_instruction::all) {
+        matched = _mm256_or_si256(matched,
+                                  _mm256_cmpeq_epi8(v, _mm256_set1_epi8(instr)));
+    }
+    return matched;
+}
+
+[[gnu::target("avx2")]]
+std::size_t instruction_prefix(const char* data, std::size_t size) noexcept
+{
+    auto i = std::size_t{0};
+    for (; i + lanes <= size; i += lanes) {
+        if (!all_set(instruction_mask(load(data + i)))) {
+            break;
+        }
+    }
+
+    return i;
+}
+
+[[gnu::target("avx2")]]
+std::size_t denormalise_prefix(char* data, std::size_t size) noexcept
+{
+    auto i = std::size_t{0};
+    for (; i + lanes <= size; i += lanes) {
+        const auto v = load(data + i);
+
+        auto matched = _mm256_setzero_si256();
+        auto mapped = _mm256_setzero_si256();
+        for (auto instr : cpu_instruction::all) {
+            const auto m = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(instr));
+            matched = _mm256_or_si256(matched, m);
+            mapped = _mm256_or_si256(mapped, _mm256_and_si256(
+                m,
+                _mm256_set1_epi8(detail::char_lookup(detail::denormalise_map, instr))));
+        }
+        if (!all_set(matched)) {
+            break;
+        }
+
+        auto sub = _mm256_sub_epi8(mapped, lane_offsets(i));
+        const auto low = _mm256_cmpgt_epi8(
+            _mm256_set1_epi8(graphical_ascii_range.first),
+            sub);
+        sub = _mm256_add_epi8(sub, _mm256_and_si256(low,
+                                                    _mm256_set1_epi8(cipher::size)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), sub);
+    }
+
+    return i;
+}
+
+[[gnu::target("avx2")]]
+detail::normalise_progress normalise_prefix(char* data, std::size_t size) noexcept
+{
+    const auto& pre_index = instruction_pre_index();
+    auto progress = detail::normalise_progress{};
+    while (progress.read + lanes <= size) {
+        // Non-graphical characters (including whitespace) are out of range
+        const auto x = _mm256_sub_epi8(load(data + progress.read),
+                                       _mm256_set1_epi8(graphical_ascii_range.first));
+        const auto graphical = _mm256_cmpeq_epi8(
+            _mm256_min_epu8(x, _mm256_set1_epi8(cipher::size - 1)),
+            x);
+
+        if (all_set(graphical)) {
+            const auto index = wrap_cipher(_mm256_add_epi8(
+                x,
+                lane_offsets(progress.written)));
+
+            auto matched = _mm256_setzero_si256();
+            auto out = _mm256_setzero_si256();
+            for (auto i = 0u; i < cpu_instruction::all.size(); ++i) {
+                const auto m = _mm256_cmpeq_epi8(
+                    index,
+                    _mm256_set1_epi8(pre_index[i]));
+                matched = _mm256_or_si256(matched, m);
+                out = _mm256_or_si256(out, _mm256_and_si256(
+                    m,
+                    _mm256_set1_epi8(cpu_instruction::all[i])));
+            }
+
+            if (all_set(matched)) {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + progress.written),
+                                    out);
+                progress.read += lanes;
+                progress.written += lanes;
+                progress.loc.column += lanes;
+                continue;
+            }
+        }
+
+        // Whitespace, or a character that needs a diagnostic
+        if (!normalise_scalar(data, progress.read + lanes, progress)) {
+            break;
+        }
+    }
+
+    return progress;
+}
+}
+#endif
+}
+
+detail::simd_level detail::max_simd_level() noexcept
+{
+    static const auto level = detect_simd_level();
+    return level;
+}
+
+detail::simd_level detail::active_simd_level() noexcept
+{
+    return current_simd_level().load(std::memory_order_relaxed);
+}
+
+void detail::set_simd_level(simd_level level) noexcept
+{
+    current_simd_level().store(std::min(level, max_simd_level()),
+                               std::memory_order_relaxed);
+}
+
+detail::normalise_progress detail::normalise_prefix(char* data,
+                                                    std::size_t size) noexcept
+{
+    switch (active_simd_level()) {
+#ifdef MALBOLGE_X86_KERNELS
+    case simd_level::AVX2:
+        return avx2::normalise_prefix(data, size);
+    case simd_level::SSE4_2:
+        return sse4_2::normalise_prefix(data, size);
+#endif
+    default:
+        return {};
+    }
+}
+
+std::size_t detail::denormalise_prefix(char* data, std::size_t size) noexcept
+{
+    switch (active_simd_level()) {
+#ifdef MALBOLGE_X86_KERNELS
+    case simd_level::AVX2:
+        return avx2::denormalise_prefix(data, size);
+    case simd_level::SSE4_2:
+        return sse4_2::denormalise_prefix(data, size);
+#endif
+    default:
+        return 0;
+    }
+}
+
+std::size_t detail::instruction_prefix(const char* data, std::size_t size) noexcept
+{
+    switch (active_simd_level()) {
+#ifdef MALBOLGE_X86_KERNELS
+    case simd_level::AVX2:
+        return avx2::instruction_prefix(data, size);
+    case simd_level::SSE4_2:
+        return sse4_2::instruction_prefix(data, size);
+#endif
+    default:
+        return 0;
+    }
+}
@@ -9,6 +9,7 @@
 #include "malbolge/exception.hpp"
 #include "malbolge/version.hpp"
 
+#include <array>
 #include <deque>
 
 using namespace malbolge;
@@ -24,6 +25,11 @@ constexpr auto log_flag_prefix      = "-l";
 constexpr auto string_flag          = "--string";
 constexpr auto debugger_script_flag = "--debugger-script";
 constexpr auto force_nn_flag        = "--force-non-normalised";
+constexpr auto corpus_flag          = "--corpus";
+constexpr auto output_dir_flag      = "--output-dir";
+constexpr auto corpus_ops           = std::array{"validate"sv,
+                                                 "normalise"sv,
+                                                 "denormalise"sv};
 }
 
 argument_parser::argument_parser(int argc, char* argv[]) :
@@ -99,6 +105,50 @@ argument_parser::argument_parser(int argc, char* argv[]) :
         args.erase(debugger_script_it);
     }
 
+    auto corpus_it = std::find(args.begin(), args.end(), corpus_flag);
+    if (corpus_it != args.end()) {
+        if (++corpus_it == args.end()) {
+            throw system_exception{
+                "Corpus flag set but no operation present",
+                std::errc::invalid_argument
+            };
+        }
+
+        const auto op_it = std::find(corpus_ops.begin(), corpus_ops.end(), *corpus_it);
+        if (op_it == corpus_ops.end()) {
+            throw system_exception{"Unknown corpus operation: "s + *corpus_it,
+                                   std::errc::invalid_argument};
+        }
+        corpus_ = corpus_data{
+            static_cast<corpus_operation>(op_it - corpus_ops.begin()),
+            {},
+            {}
+        };
+
+        corpus_it = args.erase(--corpus_it);
+        args.erase(corpus_it);
+    }
+
+    auto output_dir_it = std::find(args.begin(), args.end(), output_dir_flag);
+    if (output_dir_it != args.end()) {
+        if (!corpus_) {
+            throw system_exception{"Output directory flag requires corpus flag",
+                                   std::errc::invalid_argument};
+        }
+
+        if (++output_dir_it == args.end()) {
+            throw system_exception{
+                "Output directory flag set but no path present",
+                std::errc::invalid_argument
+            };
+        }
+
+        corpus_->output_dir = *output_dir_it;
+
+        output_dir_it = args.erase(--output_dir_it);
+        args.erase(output_dir_it);
+    }
+
     // Log level
     if (args.size() && args.front().starts_with(log_flag_prefix)) {
         // There must only be 'l's
@@ -130,6 +180,27 @@ argument_parser::argument_parser(int argc, char* argv[]) :
         }
     }
 
+    // In corpus mode the remaining arguments are the input directories
+    if (corpus_) {
+        if (p_.source == program_source::STRING || debugger_script_) {
+            throw system_exception{
+                "Corpus flag cannot be used with string or debugger script flags",
+                std::errc::invalid_argument
+            };
+        }
+        if (args.empty()) {
+            throw system_exception{"Corpus flag set but no directories present",
+                                   std::errc::invalid_argument};
+        }
+        if (corpus_->op != corpus_operation::VALIDATE && !corpus_->output_dir) {
+            throw system_exception{"Corpus operation requires an output directory",
+                                   std::errc::invalid_argument};
+        }
+
+        corpus_->dirs.assign(args.begin(), args.end());
+        return;
+    }
+
     // There should either be a path for a file to load, or nothing
     if (!args.empty()) {
         // Make sure the string flag hadn't already been set
@@ -172,7 +243,8 @@ std::ostream& malbolge::operator<<(std::ostream& stream, const argument_parser&)
     return stream << "Malbolge virtual machine v" << project_version
                   << "\nUsage:"
                      "\n\tmalbolge [options] <file>\n"
-                     "\tcat <file> | malbolge [options]\n\n"
+                     "\tcat <file> | malbolge [options]\n"
+                     "\tmalbolge [options] --corpus <op> [--output-dir <dir>] <dir>...\n\n"
                      "Options:\n"
                   << "\t" << help_flags[1] << " " << help_flags[0]
                   << "\t\tDisplay this help message\n"
@@ -185,5 +257,10 @@ std::ostream& malbolge::operator<<(std::ostream& stream, const argument_parser&)
                   << "\t" << debugger_script_flag
                   << "\tRun the given debugger script on the program\n"
                   << "\t" << force_nn_flag
-                  << "\tOverride normalised program detection to force to non-normalised";
+                  << "\tOverride normalised program detection to force to non-normalised\n"
+                  << "\t" << corpus_flag
+                  << "\t\tApply an operation (validate, normalise, or denormalise)\n"
+                     "\t\t\tto every .mal file in the given directories, in parallel\n"
+                  << "\t" << output_dir_flag
+                  << "\t\tCorpus output directory, required to (de)normalise";
 }
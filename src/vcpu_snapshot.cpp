@@ -0,0 +1,239 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/vcpu_snapshot.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <istream>
+#include <ostream>
+
+using namespace malbolge;
+
+namespace
+{
+// Snapshot layout, all integers are unsigned little-endian:
+//  - magic, format version (u32)
+//  - A (u16), C (u16), D (u16), p_counter (u64), output count (u64)
+//  - Fill mask, one bit per memory cell (LSB first), set if the cell is the
+//    ternary op of the previous two cells
+//  - Every cell that is not in the fill mask (u16)
+//  - Input count (u64), then each input's length (u64) and data
+//  - Breakpoint count (u64), then each breakpoint's address (u16), ignore
+//    count (u64), and hit flag (u8)
+constexpr auto magic = std::string_view{"MALBSNAP"};
+constexpr auto format_version = std::uint32_t{2};
+
+constexpr auto mem_size = std::size_t{math::ternary::max + 1u};
+constexpr auto fill_mask_size = (mem_size + 7) / 8;
+
+template <typename T>
+void write_uint(std::ostream& stream, T value)
+{
+    auto bytes = std::array<char, sizeof(T)>{};
+    for (auto& b : bytes) {
+        b = static_cast<char>(value & 0xFF);
+        value >>= 8;
+    }
+    stream.write(bytes.data(), bytes.size());
+}
+
+void read_bytes(std::istream& stream, void* data, std::size_t size)
+{
+    stream.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+    if (!stream) {
+        throw parse_exception{"Snapshot data is truncated"};
+    }
+}
+
+template <typename T>
+[[nodiscard]]
+T read_uint(std::istream& stream)
+{
+    auto bytes = std::array<unsigned char, sizeof(T)>{};
+    read_bytes(stream, bytes.data(), bytes.size());
+
+    auto value = T{0};
+    for (auto i = bytes.size(); i > 0; --i) {
+        value = static_cast<T>((value << 8) | bytes[i-1]);
+    }
+    return value;
+}
+
+[[nodiscard]]
+math::ternary read_ternary(std::istream& stream, std::string_view name)
+{
+    const auto value = read_uint<std::uint16_t>(stream);
+    if (value > math::ternary::max) {
+        throw parse_exception{std::string{name} + " out of range: " +
+                              std::to_string(value)};
+    }
+    return value;
+}
+
+[[nodiscard]]
+bool is_fill_cell(const virtual_memory& vmem, std::size_t i) noexcept
+{
+    return i >= 2 &&
+           vmem.unchecked_at(i) == vmem.unchecked_at(i-1).op(vmem.unchecked_at(i-2));
+}
+
+void write_memory(std::ostream& stream, const virtual_memory& vmem)
+{
+    auto mask = std::array<char, fill_mask_size>{};
+    for (auto i = std::size_t{0}; i < mem_size; ++i) {
+        if (is_fill_cell(vmem, i)) {
+            mask[i / 8] = static_cast<char>(mask[i / 8] | (1 << (i % 8)));
+        }
+    }
+    stream.write(mask.data(), mask.size());
+
+    for (auto i = std::size_t{0}; i < mem_size; ++i) {
+        if (!is_fill_cell(vmem, i)) {
+            write_uint(stream, static_cast<std::uint16_t>(vmem.unchecked_at(i)));
+        }
+    }
+}
+
+[[nodiscard]]
+virtual_memory read_memory(std::istream& stream)
+{
+    auto mask = std::array<unsigned char, fill_mask_size>{};
+    read_bytes(stream, mask.data(), mask.size());
+    if (mask[0] & 0x3) {
+        throw parse_exception{"The first two memory cells cannot be filled"};
+    }
+
+    return virtual_memory(std::in_place, [&](auto first, auto) {
+        for (auto i = std::size_t{0}; i < mem_size; ++i) {
+            if (mask[i / 8] & (1 << (i % 8))) {
+                first[i] = first[i-1].op(first[i-2]);
+            } else {
+                first[i] = read_ternary(stream, "Memory cell");
+            }
+        }
+        return mem_size;
+    });
+}
+
+[[nodiscard]]
+std::string read_string(std::istream& stream)
+{
+    // The length is untrusted, so don't allocate it all up front
+    constexpr auto chunk_size = std::size_t{4096};
+
+    auto remaining = read_uint<std::uint64_t>(stream);
+    auto str = std::string{};
+    while (remaining) {
+        const auto n = static_cast<std::size_t>(
+            std::min<std::uint64_t>(remaining, chunk_size));
+        const auto offset = str.size();
+        str.resize(offset + n);
+        read_bytes(stream, str.data() + offset, n);
+        remaining -= n;
+    }
+
+    return str;
+}
+}
+
+void malbolge::save_snapshot(const vcpu_snapshot& snapshot, std::ostream& stream)
+{
+    stream.write(magic.data(), magic.size());
+    write_uint(stream, format_version);
+
+    write_uint(stream, static_cast<std::uint16_t>(snapshot.a));
+    write_uint(stream, static_cast<std::uint16_t>(snapshot.c));
+    write_uint(stream, static_cast<std::uint16_t>(snapshot.d));
+    write_uint(stream, static_cast<std::uint64_t>(snapshot.p_counter));
+    write_uint(stream, static_cast<std::uint64_t>(snapshot.output_count));
+
+    write_memory(stream, snapshot.vmem);
+
+    write_uint(stream, static_cast<std::uint64_t>(snapshot.input.size()));
+    for (const auto& input : snapshot.input) {
+        write_uint(stream, static_cast<std::uint64_t>(input.size()));
+        stream.write(input.data(), static_cast<std::streamsize>(input.size()));
+    }
+
+    write_uint(stream, static_cast<std::uint64_t>(snapshot.breakpoints.size()));
+    for (const auto& bp : snapshot.breakpoints) {
+        write_uint(stream, static_cast<std::uint16_t>(bp.address));
+        write_uint(stream, static_cast<std::uint64_t>(bp.ignore_count));
+        write_uint(stream, static_cast<std::uint8_t>(bp.hit));
+    }
+
+    if (!stream.flush()) {
+        throw system_exception{"Failed to write snapshot", std::errc::io_error};
+    }
+}
+
+void malbolge::save_snapshot(const vcpu_snapshot& snapshot,
+                             const std::filesystem::path& path)
+{
+    auto stream = std::ofstream{path, std::ios::binary | std::ios::trunc};
+    if (!stream) {
+        throw system_exception{"Failed to open snapshot file: " + path.string(),
+                               std::errc::io_error};
+    }
+
+    save_snapshot(snapshot, stream);
+}
+
+vcpu_snapshot malbolge::load_snapshot(std::istream& stream)
+{
+    auto header = std::array<char, magic.size()>{};
+    read_bytes(stream, header.data(), header.size());
+    if (std::string_view{header.data(), header.size()} != magic) {
+        throw parse_exception{"Not a vCPU snapshot"};
+    }
+
+    const auto version = read_uint<std::uint32_t>(stream);
+    if (version != format_version) {
+        throw parse_exception{"Unsupported snapshot version: " +
+                              std::to_string(version)};
+    }
+
+    const auto a = read_ternary(stream, "A register");
+    const auto c = read_ternary(stream, "C register");
+    const auto d = read_ternary(stream, "D register");
+    const auto p_counter = read_uint<std::uint64_t>(stream);
+    const auto output_count = read_uint<std::uint64_t>(stream);
+
+    auto snapshot = vcpu_snapshot{
+        read_memory(stream),
+        a,
+        static_cast<virtual_memory::size_type>(c),
+        static_cast<virtual_memory::size_type>(d),
+        static_cast<std::size_t>(p_counter),
+        {},
+        {},
+        static_cast<std::size_t>(output_count)
+    };
+
+    for (auto n = read_uint<std::uint64_t>(stream); n > 0; --n) {
+        snapshot.input.push_back(read_string(stream));
+    }
+
+    for (auto n = read_uint<std::uint64_t>(stream); n > 0; --n) {
+        auto& bp = snapshot.breakpoints.emplace_back();
+        bp.address = read_ternary(stream, "Breakpoint address");
+        bp.ignore_count = static_cast<std::size_t>(read_uint<std::uint64_t>(stream));
+        bp.hit = read_uint<std::uint8_t>(stream) != 0;
+    }
+
+    return snapshot;
+}
+
+vcpu_snapshot malbolge::load_snapshot(const std::filesystem::path& path)
+{
+    auto stream = std::ifstream{path, std::ios::binary};
+    if (!stream) {
+        throw parse_exception{"Failed to open snapshot file: " + path.string()};
+    }
+
+    return load_snapshot(stream);
+}
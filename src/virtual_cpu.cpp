@@ -4,31 +4,89 @@
  */
 
 #include "malbolge/virtual_cpu.hpp"
-#include "malbolge/cpu_instruction.hpp"
+#include "malbolge/detail/interpreter.hpp"
 #include "malbolge/log.hpp"
 
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/executor_work_guard.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
 
+#include <algorithm>
 #include <thread>
 #include <deque>
 #include <unordered_map>
 #include <atomic>
+#include <bitset>
+#include <optional>
+#include <string_view>
+#include <utility>
 
 using namespace malbolge;
 
+namespace
+{
+// Snapshots built in code are not range checked like load_snapshot(...) does,
+// and the interpreter indexes memory directly with the registers
+void snapshot_check(const vcpu_snapshot& snapshot)
+{
+    auto check_register = [&](auto value, std::string_view name) {
+        if (value > math::ternary::max) {
+            throw execution_exception{"Snapshot " + std::string{name} +
+                                          " register out of range: " +
+                                          std::to_string(value),
+                                      snapshot.p_counter};
+        }
+    };
+    check_register(snapshot.c, "C");
+    check_register(snapshot.d, "D");
+
+    auto addresses = std::bitset<math::ternary::max + 1u>{};
+    for (const auto& bp : snapshot.breakpoints) {
+        const auto address = static_cast<std::size_t>(bp.address);
+        if (addresses.test(address)) {
+            throw execution_exception{"Snapshot breakpoint address duplicated: " +
+                                          std::to_string(address),
+                                      snapshot.p_counter};
+        }
+        addresses.set(address);
+    }
+}
+
+[[nodiscard]]
+virtual_memory checked_memory(vcpu_snapshot& snapshot)
+{
+    snapshot_check(snapshot);
+    return std::move(snapshot.vmem);
+}
+}
+
 class virtual_cpu::impl_t : public std::enable_shared_from_this<impl_t>
 {
 public:
     class breakpoint
     {
     public:
-        breakpoint(math::ternary a, std::size_t i = 0) :
+        breakpoint(math::ternary a, std::size_t i = 0, bool hit = false) :
             address_{a},
             ignore_count_{i},
-            pre_{false}
+            pre_{hit}
         {}
 
+        [[nodiscard]]
+        std::size_t ignore_count() const noexcept
+        {
+            return ignore_count_;
+        }
+
+        [[nodiscard]]
+        bool hit() const noexcept
+        {
+            return pre_;
+        }
+
         [[nodiscard]]
         bool operator()() noexcept
         {
@@ -78,20 +136,102 @@ public:
             return c;
         }
 
+        [[nodiscard]]
+        std::string_view remaining() const noexcept
+        {
+            return view_;
+        }
+
     private:
         std::string phrase_;
         std::string_view view_;
     };
 
+    // Maximum number of instructions executed in a single run() handler before
+    // yielding back to the event loop
+    static constexpr auto max_burst_size = std::size_t{4096};
+
+    // Creates and owns an event loop, the caller must start the thread
     explicit impl_t(virtual_memory vm) :
-        worker_guard_{ctx.get_executor()},
-        vmem(std::move(vm)),
-        c{vmem.begin()},
-        d{vmem.begin()},
-        p_counter{0},
+        owned_ctx_{std::make_unique<boost::asio::io_context>()},
+        strand_{boost::asio::make_strand(*owned_ctx_)},
+        worker_guard_{owned_ctx_->get_executor()},
+        deadline_timer_{strand_},
+        core{std::move(vm)},
+        engine_{virtual_cpu::engine_type::STANDARD},
+        output_count_{0},
+        output_limit_hit_{false},
+        char_output_{false},
+        buffered_output_{false},
+        detached_{false},
+        pending_requests_{0},
         state_{virtual_cpu::execution_state::READY}
     {}
 
+    // Runs on the external ctx, serialised by a strand as it may be ran by
+    // multiple threads
+    impl_t(virtual_memory vm, boost::asio::io_context& ctx) :
+        strand_{boost::asio::make_strand(ctx)},
+        deadline_timer_{strand_},
+        core{std::move(vm)},
+        engine_{virtual_cpu::engine_type::STANDARD},
+        output_count_{0},
+        output_limit_hit_{false},
+        char_output_{false},
+        buffered_output_{false},
+        detached_{false},
+        pending_requests_{0},
+        state_{virtual_cpu::execution_state::READY}
+    {}
+
+    [[nodiscard]]
+    bool owns_event_loop() const noexcept
+    {
+        return !!owned_ctx_;
+    }
+
+    // Posts f into the event loop, a running burst will yield to it at the
+    // next instruction boundary
+    template <typename F>
+    void post(F&& f)
+    {
+        ++pending_requests_;
+        boost::asio::post(strand_, [impl = shared_from_this(),
+                                    f = std::forward<F>(f)]() mutable {
+            --impl->pending_requests_;
+            impl->guarded([&]() { f(impl); });
+        });
+    }
+
+    // An exception escaping a handler stops an owned event loop's thread,
+    // which then sets the STOPPED state.  An external event loop is not ours
+    // to stop, so the exception is caught and the state set here instead
+    template <typename F>
+    void guarded(F&& f)
+    {
+        if (detached_) {
+            return;
+        }
+
+        if (owns_event_loop()) {
+            f();
+            return;
+        }
+
+        try {
+            f();
+        } catch (std::exception&) {
+            set_state(virtual_cpu::execution_state::STOPPED,
+                      std::current_exception());
+        }
+    }
+
+    [[nodiscard]]
+    bool requests_pending() const noexcept
+    {
+        return pending_requests_.load(std::memory_order_relaxed) != 0;
+    }
+
     [[nodiscard]]
     virtual_cpu::execution_state state() const noexcept
     {
@@ -105,50 +245,175 @@ public:
             return;
         }
 
+        // A pending deadline would otherwise keep an external event loop busy
+        if (new_state == virtual_cpu::execution_state::STOPPED) {
+            deadline_timer_.cancel();
+        }
+
+        flush_output();
         state_ = new_state;
         state_sig(state_, eptr);
     }
 
+    void write_output(char c)
+    {
+        if (output_count_ == limits_.max_output) [[unlikely]] {
+            output_limit_hit_ = true;
+            return;
+        }
+        ++output_count_;
+
+        if (char_output_.load(std::memory_order_relaxed)) {
+            output_sig(c);
+        }
+        if (buffered_output_.load(std::memory_order_relaxed)) {
+            output_buf_.push_back(c);
+            if (output_buf_.size() >= virtual_cpu::output_buffer_size) {
+                flush_output();
+            }
+        }
+    }
+
+    void flush_output()
+    {
+        if (output_buf_.empty()) {
+            return;
+        }
+
+        buffered_output_sig(output_buf_);
+        output_buf_.clear();
+    }
+
     void stop()
     {
-        worker_guard_.reset();
-        ctx.stop();
-        if (thread.joinable()) {
-            thread.join();
+        if (owns_event_loop()) {
+            worker_guard_.reset();
+            owned_ctx_->stop();
+            if (thread.joinable()) {
+                thread.join();
+            }
+            return;
         }
+
+        // Any queued handlers (including a burst) become no-ops, and the final
+        // state change is emitted from the event loop
+        detached_ = true;
+        boost::asio::dispatch(strand_, [impl = shared_from_this()]() {
+            impl->set_state(virtual_cpu::execution_state::STOPPED);
+        });
     }
 
     void stopped_check()
     {
         // Once in a STOPPED state, it cannot change to another
         if (state_ == virtual_cpu::execution_state::STOPPED) {
-            throw execution_exception{"vCPU has been stopped", p_counter};
+            throw execution_exception{"vCPU has been stopped", core.p_counter};
         }
     }
 
-    bool bp_check(virtual_memory::iterator reg_it);
+    // Throws a limit_exception if the instruction or output limit has been
+    // reached.  The deadline is enforced separately by deadline_timer_
+    void limits_check() const
+    {
+        if (output_limit_hit_) [[unlikely]] {
+            throw limit_exception{limit_exception::limit_type::OUTPUT,
+                                  core.p_counter};
+        }
+        if (core.p_counter >= limits_.max_steps) [[unlikely]] {
+            throw limit_exception{limit_exception::limit_type::STEPS,
+                                  core.p_counter};
+        }
+    }
 
-    void run(bool schedule_next = true);
+    // Number of instructions the next burst can execute without exceeding the
+    // instruction limit
+    [[nodiscard]]
+    std::size_t burst_size() const noexcept
+    {
+        return std::min(max_burst_size, limits_.max_steps - core.p_counter);
+    }
 
-    boost::asio::io_context ctx;
-    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> worker_guard_;
+    void set_limits(const execution_limits& limits);
+
+    bool bp_check(virtual_memory::size_type address);
+
+    void add_breakpoint(math::ternary address, std::size_t ignore_count)
+    {
+        bps.insert_or_assign(address, breakpoint{address, ignore_count});
+        bp_mask_.set(static_cast<std::size_t>(address));
+    }
+
+    void remove_breakpoint(math::ternary address)
+    {
+        bps.erase(address);
+        bp_mask_.reset(static_cast<std::size_t>(address));
+    }
+
+    [[nodiscard]]
+    vcpu_snapshot snapshot() const;
+
+    // Restores everything but the memory from snapshot
+    void restore(const vcpu_snapshot& snapshot);
+
+    void run();
+
+    // Returns true if execution can continue onto the next instruction.  If
+    // CheckBreakpoints is false then breakpoints are ignored, it is only safe
+    // to do so if none are set
+    template <bool CheckBreakpoints>
+    bool step(bool ignore_pause = false);
+
+    // Runs up to max_burst_size instructions, returns false if execution
+    // cannot continue
+    template <bool CheckBreakpoints>
+    bool run_burst();
+
+    // As run_burst<false>(), but using the threaded interpreter core.  If
+    // Fused is true then the fused cipher transition table is used
+    template <bool Fused>
+    bool run_threaded_burst();
+
+    // Returns the next input character, or an empty optional if there is none
+    // queued
+    std::optional<math::ternary> read_input();
+
+    // Sets the state from an interpreter result, returns false if execution
+    // cannot continue
+    bool handle_step_result(detail::interpreter::step_result result);
+
+    std::unique_ptr<boost::asio::io_context> owned_ctx_;
+    boost::asio::strand<boost::asio::io_context::executor_type> strand_;
+    std::optional<boost::asio::executor_work_guard<
+        boost::asio::io_context::executor_type>> worker_guard_;
+    boost::asio::steady_timer deadline_timer_;
     std::thread thread;
 
-    virtual_memory vmem;
+    detail::interpreter core;
+    virtual_cpu::engine_type engine_;
     std::deque<input> input_queue_;
+    std::string output_buf_;
+    execution_limits limits_;
+    std::size_t output_count_;
+    bool output_limit_hit_;
     std::unordered_map<math::ternary, breakpoint> bps;
 
-    // vCPU Registers
-    math::ternary a;
-    virtual_memory::iterator c;
-    virtual_memory::iterator d;
-    std::size_t p_counter;
+    // Dense copy of the breakpoint addresses, so the common case of there
+    // being no breakpoint at C doesn't need a hash lookup
+    std::bitset<math::ternary::max + 1> bp_mask_;
 
     state_signal_type state_sig;
     output_signal_type output_sig;
+    buffered_output_signal_type buffered_output_sig;
     breakpoint_hit_signal_type bp_hit_sig;
 
+    // Output is only pushed to a signal if something has connected to it, so
+    // the unused path costs nothing per character
+    std::atomic<bool> char_output_;
+    std::atomic<bool> buffered_output_;
+
 private:
+    std::atomic<bool> detached_;
+    std::atomic<std::size_t> pending_requests_;
     std::atomic<virtual_cpu::execution_state> state_;
 };
 
@@ -158,7 +423,7 @@ virtual_cpu::virtual_cpu(virtual_memory vmem) :
     impl_->thread = std::thread{[impl = impl_]() {
         auto eptr = std::exception_ptr{};
         try {
-            impl->ctx.run();
+            impl->owned_ctx_->run();
         } catch (std::exception&) {
             eptr = std::current_exception();
         }
@@ -166,6 +431,24 @@ virtual_cpu::virtual_cpu(virtual_memory vmem) :
     }};
 }
 
+virtual_cpu::virtual_cpu(virtual_memory vmem, boost::asio::io_context& ctx) :
+    impl_{std::make_shared<impl_t>(std::move(vmem), ctx)}
+{}
+
+virtual_cpu::virtual_cpu(vcpu_snapshot snapshot) :
+    virtual_cpu{checked_memory(snapshot)}
+{
+    // Nothing can have been posted to the event loop yet, so this is safe to
+    // call from here
+    impl_->restore(snapshot);
+}
+
+virtual_cpu::virtual_cpu(vcpu_snapshot snapshot, boost::asio::io_context& ctx) :
+    virtual_cpu{checked_memory(snapshot), ctx}
+{
+    impl_->restore(snapshot);
+}
+
 virtual_cpu::~virtual_cpu()
 {
     if (!impl_) [[unlikely]] {
@@ -178,7 +461,7 @@ void virtual_cpu::run()
 {
     impl_check();
     impl_->stopped_check();
-    boost::asio::post(impl_->ctx, [impl = impl_]() {
+    impl_->post([](auto& impl) {
         if (impl->state() == execution_state::RUNNING ||
             impl->state() == execution_state::WAITING_FOR_INPUT) {
             return;
@@ -193,7 +476,7 @@ void virtual_cpu::pause()
 {
     impl_check();
     impl_->stopped_check();
-    boost::asio::post(impl_->ctx, [impl = impl_]() {
+    impl_->post([](auto& impl) {
         if (impl->state() == execution_state::PAUSED ||
             impl->state() == execution_state::WAITING_FOR_INPUT) {
             return;
@@ -207,20 +490,21 @@ void virtual_cpu::step()
 {
     impl_check();
     impl_->stopped_check();
-    boost::asio::post(impl_->ctx, [impl = impl_]() {
+    impl_->post([](auto& impl) {
         if (impl->state() == execution_state::WAITING_FOR_INPUT) {
             return;
         }
 
+        impl->limits_check();
         impl->set_state(execution_state::PAUSED);
-        impl->run(false);
+        impl->template step<true>(true);
     });
 }
 
 void virtual_cpu::add_input(std::string data)
 {
     impl_check();
-    boost::asio::post(impl_->ctx, [impl = impl_, data = std::move(data)]() {
+    impl_->post([data = std::move(data)](auto& impl) mutable {
         impl->input_queue_.emplace_back(std::move(data));
         if (impl->state() == execution_state::WAITING_FOR_INPUT) {
             impl->set_state(execution_state::RUNNING);
@@ -229,20 +513,50 @@ void virtual_cpu::add_input(std::string data)
     });
 }
 
+void virtual_cpu::restore(vcpu_snapshot snapshot)
+{
+    impl_check();
+    impl_->stopped_check();
+    snapshot_check(snapshot);
+    impl_->post([snapshot = std::move(snapshot)](auto& impl) mutable {
+        impl->core.vmem = std::move(snapshot.vmem);
+        impl->restore(snapshot);
+        if (impl->state() == execution_state::WAITING_FOR_INPUT) {
+            impl->set_state(execution_state::RUNNING);
+            impl->run();
+        }
+    });
+}
+
+void virtual_cpu::set_engine(engine_type engine)
+{
+    impl_check();
+    impl_->post([engine](auto& impl) {
+        impl->engine_ = engine;
+    });
+}
+
+void virtual_cpu::set_limits(execution_limits limits)
+{
+    impl_check();
+    impl_->post([limits = std::move(limits)](auto& impl) {
+        impl->set_limits(limits);
+    });
+}
+
 void virtual_cpu::add_breakpoint(math::ternary address, std::size_t ignore_count)
 {
     impl_check();
-    boost::asio::post(impl_->ctx, [impl = impl_, address, ignore_count]() {
-        auto bp = impl_t::breakpoint{address, ignore_count};
-        impl->bps.insert_or_assign(address, std::move(bp));
+    impl_->post([address, ignore_count](auto& impl) {
+        impl->add_breakpoint(address, ignore_count);
     });
 }
 
 void virtual_cpu::remove_breakpoint(math::ternary address)
 {
     impl_check();
-    boost::asio::post(impl_->ctx, [impl = impl_, address]() {
-        impl->bps.erase(address);
+    impl_->post([address](auto& impl) {
+        impl->remove_breakpoint(address);
     });
 }
 
@@ -250,8 +564,8 @@ void virtual_cpu::address_value(math::ternary address,
                                 address_value_callback_type cb) const
 {
     impl_check();
-    boost::asio::post(impl_->ctx, [impl = impl_, address, cb = std::move(cb)]() {
-        const auto value = impl->vmem[address];
+    impl_->post([address, cb = std::move(cb)](auto& impl) {
+        const auto value = std::as_const(impl->core.vmem)[address];
         cb(address, value);
     });
 }
@@ -260,34 +574,40 @@ void virtual_cpu::register_value(vcpu_register reg,
                                  register_value_callback_type cb) const
 {
     impl_check();
-    boost::asio::post(impl_->ctx, [impl = impl_, reg, cb = std::move(cb)]() {
+    impl_->post([reg, cb = std::move(cb)](auto& impl) {
         switch (reg) {
         case vcpu_register::A:
-            cb(reg, {}, impl->a);
+            cb(reg, {}, impl->core.a);
             break;
         case vcpu_register::C:
         {
-            const auto address = static_cast<math::ternary::underlying_type>(
-                                    std::distance(impl->vmem.begin(), impl->c));
-            cb(reg, address, impl->vmem[address]);
+            const auto address = static_cast<math::ternary::underlying_type>(impl->core.c);
+            cb(reg, address, std::as_const(impl->core.vmem).unchecked_at(impl->core.c));
             break;
         }
         case vcpu_register::D:
         {
-            const auto address = static_cast<math::ternary::underlying_type>(
-                                    std::distance(impl->vmem.begin(), impl->d));
-            cb(reg, address, impl->vmem[address]);
+            const auto address = static_cast<math::ternary::underlying_type>(impl->core.d);
+            cb(reg, address, std::as_const(impl->core.vmem).unchecked_at(impl->core.d));
             break;
         }
         default:
             throw execution_exception{
                 "Unhandled register query: " + std::to_string(static_cast<int>(reg)),
-                impl->p_counter
+                impl->core.p_counter
             };
         }
     });
 }
 
+void virtual_cpu::snapshot(snapshot_callback_type cb) const
+{
+    impl_check();
+    impl_->post([cb = std::move(cb)](auto& impl) {
+        cb(impl->snapshot());
+    });
+}
+
 virtual_cpu::state_signal_type::connection
 virtual_cpu::register_for_state_signal(state_signal_type::slot_type slot)
 {
@@ -299,9 +619,18 @@ virtual_cpu::output_signal_type::connection
 virtual_cpu::register_for_output_signal(output_signal_type::slot_type slot)
 {
     impl_check();
+    impl_->char_output_ = true;
     return impl_->output_sig.connect(std::move(slot));
 }
 
+virtual_cpu::buffered_output_signal_type::connection
+virtual_cpu::register_for_buffered_output_signal(buffered_output_signal_type::slot_type slot)
+{
+    impl_check();
+    impl_->buffered_output_ = true;
+    return impl_->buffered_output_sig.connect(std::move(slot));
+}
+
 virtual_cpu::breakpoint_hit_signal_type::connection
 virtual_cpu::register_for_breakpoint_hit_signal(breakpoint_hit_signal_type::slot_type slot)
 {
@@ -316,11 +645,103 @@ void virtual_cpu::impl_check() const
     }
 }
 
-bool virtual_cpu::impl_t::bp_check(virtual_memory::iterator reg_it)
+vcpu_snapshot virtual_cpu::impl_t::snapshot() const
 {
-    const auto address = static_cast<math::ternary::underlying_type>(
-        std::distance(vmem.begin(), reg_it)
-    );
+    // A clone would be cheaper, but would leave the vCPU's memory paged for
+    // the rest of the run
+    auto result = vcpu_snapshot{
+        virtual_memory(std::in_place, [&](auto first, auto last) {
+            for (auto i = virtual_memory::size_type{0}; first != last; ++i, ++first) {
+                *first = core.vmem.unchecked_at(i);
+            }
+            return core.vmem.size();
+        }),
+        core.a,
+        core.c,
+        core.d,
+        core.p_counter,
+        {},
+        {},
+        output_count_
+    };
+
+    for (const auto& in : input_queue_) {
+        result.input.emplace_back(in.remaining());
+    }
+
+    for (const auto& [address, bp] : bps) {
+        result.breakpoints.push_back({address, bp.ignore_count(), bp.hit()});
+    }
+    std::sort(result.breakpoints.begin(),
+              result.breakpoints.end(),
+              [](auto&& lhs, auto&& rhs) { return lhs.address < rhs.address; });
+
+    return result;
+}
+
+void virtual_cpu::impl_t::restore(const vcpu_snapshot& snapshot)
+{
+    core.a = snapshot.a;
+    core.c = snapshot.c;
+    core.d = snapshot.d;
+    core.p_counter = snapshot.p_counter;
+
+    // output_limit_hit_ only flags a dropped write until the limits are next
+    // checked, so it isn't part of the snapshot
+    output_count_ = snapshot.output_count;
+    output_limit_hit_ = false;
+
+    // Like add_input(std::string), each entry ends at its first null
+    input_queue_.clear();
+    for (const auto& in : snapshot.input) {
+        input_queue_.emplace_back(in.substr(0, in.find('\0')));
+    }
+
+    bps.clear();
+    bp_mask_.reset();
+    for (const auto& bp : snapshot.breakpoints) {
+        bps.insert_or_assign(bp.address,
+                             breakpoint{bp.address, bp.ignore_count, bp.hit});
+        bp_mask_.set(static_cast<std::size_t>(bp.address));
+    }
+}
+
+void virtual_cpu::impl_t::set_limits(const execution_limits& limits)
+{
+    limits_ = limits;
+    if (!limits_.deadline || state_ == virtual_cpu::execution_state::STOPPED) {
+        deadline_timer_.cancel();
+        return;
+    }
+
+    // Resetting the expiry cancels any previous wait.  The timer's handler
+    // runs on the strand, so it is serialised with the run bursts - it fires
+    // between bursts at the latest
+    deadline_timer_.expires_at(*limits_.deadline);
+    deadline_timer_.async_wait([weak = weak_from_this()](auto ec) {
+        auto impl = weak.lock();
+        if (ec || !impl) {
+            return;
+        }
+
+        impl->guarded([&]() {
+            if (impl->state() != virtual_cpu::execution_state::STOPPED) {
+                throw limit_exception{limit_exception::limit_type::DEADLINE,
+                                      impl->core.p_counter};
+            }
+        });
+    });
+}
+
+bool virtual_cpu::impl_t::bp_check(virtual_memory::size_type reg)
+{
+    if (!bp_mask_[reg]) [[likely]] {
+        return false;
+    }
+
+    const auto address = math::ternary{
+        static_cast<math::ternary::underlying_type>(reg)
+    };
     auto it = bps.find(address);
     if (it == bps.end()) {
         return false;
@@ -332,99 +753,123 @@ bool virtual_cpu::impl_t::bp_check(virtual_memory::iterator reg_it)
     return false;
 }
 
-void virtual_cpu::impl_t::run(bool schedule_next)
+void virtual_cpu::impl_t::run()
 {
-    // A pause() needs to break the run()-chain
-    if (state_ == virtual_cpu::execution_state::PAUSED && schedule_next) {
+    // A pause() needs to break the run()-chain before the limits are checked,
+    // otherwise a pause requested as a limit is reached would be overridden
+    if (state_ == virtual_cpu::execution_state::PAUSED) {
         return;
     }
-
-    if (bp_check(c)) {
+    limits_check();
+
+    // Breakpoint and engine changes are requests, so they end the burst and we
+    // can pick the cheapest flavour for each burst
+    auto can_continue = false;
+    if (!bps.empty()) {
+        can_continue = run_burst<true>();
+    } else if (engine_ == virtual_cpu::engine_type::THREADED) {
+        can_continue = run_threaded_burst<false>();
+    } else if (engine_ == virtual_cpu::engine_type::FUSED) {
+        can_continue = run_threaded_burst<true>();
+    } else {
+        can_continue = run_burst<false>();
+    }
+    if (!can_continue) {
         return;
     }
 
-    // Pre-cipher the instruction
-    auto instr = pre_cipher_instruction(*c, c - vmem.begin());
-    if (!instr) {
-        throw execution_exception{
-            "Pre-cipher non-whitespace character must be graphical "
-                "ASCII: " + std::to_string(static_cast<int>(*c)),
-            p_counter
-        };
-    }
-
-    log::print(log::VERBOSE_DEBUG,
-               "Step: ", p_counter, ", pre-cipher instr: ",
-               static_cast<int>(*instr));
-
-    switch (*instr) {
-    case cpu_instruction::set_data_ptr:
-        d = vmem.begin() + static_cast<std::size_t>(*d);
-        break;
-    case cpu_instruction::set_code_ptr:
-        c = vmem.begin() + static_cast<std::size_t>(*d);
-        break;
-    case cpu_instruction::rotate:
-        a = d->rotate();
-        break;
-    case cpu_instruction::op:
-        a = *d = a.op(*d);
-        break;
-    case cpu_instruction::read:
-    {
-        if (input_queue_.empty()) {
-            set_state(virtual_cpu::execution_state::WAITING_FOR_INPUT);
-            log::print(log::VERBOSE_DEBUG, "\tWaiting for input...");
-            return;
+    // Don't hold onto output whilst other handlers are processed
+    flush_output();
+
+    // Schedule the next burst
+    boost::asio::post(strand_, [impl = shared_from_this()]() {
+        impl->guarded([&]() { impl->run(); });
+    });
+}
+
+template <bool CheckBreakpoints>
+bool virtual_cpu::impl_t::run_burst()
+{
+    // Execute instructions in bursts rather than posting a handler per
+    // instruction.  Any pending request (pause, step, input, breakpoint
+    // changes, queries, etc.) ends the burst early so that it is processed
+    // between the same instructions as it would be if only a single instruction
+    // was executed per handler
+    for (auto i = burst_size(); i > 0; --i) {
+        if (!step<CheckBreakpoints>()) {
+            return false;
         }
 
-        auto c = input_queue_.front().get();
-        if (!c) {
-            a = math::ternary::max;
-            input_queue_.pop_front();
-        } else {
-            a = c;
+        if (requests_pending() || output_limit_hit_) {
+            break;
         }
-        break;
     }
-    case cpu_instruction::write:
-        if (a != math::ternary::max) {
-            output_sig(static_cast<char>(a));
-        }
-        break;
-    case cpu_instruction::stop:
+
+    return true;
+}
+
+template <bool Fused>
+bool virtual_cpu::impl_t::run_threaded_burst()
+{
+    // A pause() needs to break the run()-chain
+    if (state_ == virtual_cpu::execution_state::PAUSED) {
+        return false;
+    }
+
+    const auto result = core.template run<Fused>(
+        burst_size(),
+        [this]() { return read_input(); },
+        [this](char c) { write_output(c); },
+        [this]() { return requests_pending() || output_limit_hit_; });
+    return handle_step_result(result);
+}
+
+std::optional<math::ternary> virtual_cpu::impl_t::read_input()
+{
+    if (input_queue_.empty()) {
+        return {};
+    }
+
+    auto c = input_queue_.front().get();
+    if (!c) {
+        input_queue_.pop_front();
+        return math::ternary::max;
+    }
+    return c;
+}
+
+bool virtual_cpu::impl_t::handle_step_result(detail::interpreter::step_result result)
+{
+    switch (result) {
+    case detail::interpreter::step_result::WAITING_FOR_INPUT:
+        set_state(virtual_cpu::execution_state::WAITING_FOR_INPUT);
+        return false;
+    case detail::interpreter::step_result::STOPPED:
         set_state(virtual_cpu::execution_state::STOPPED);
-        return;
+        return false;
     default:
-        // Nop
-        break;
-    }
-
-    // Post-cipher the instruction
-    auto pc = post_cipher_instruction(*c);
-    if (!pc) {
-        throw execution_exception{
-            "Post-cipher non-whitespace character must be graphical "
-                "ASCII: " + std::to_string(static_cast<int>(*c)),
-            p_counter
-        };
-    }
-    *c = *pc;
-
-    log::print(log::VERBOSE_DEBUG,
-               "\tPost-op regs - a: ", a,
-               ", c[", std::distance(vmem.begin(), c), "]: ", *c,
-               ", d[", std::distance(vmem.begin(), d), "]: ", *d);
-
-    ++c;
-    ++d;
-    ++p_counter;
-    if (schedule_next) {
-        // Schedule the next iteration
-        boost::asio::post(ctx, [impl = shared_from_this()]() {
-            impl->run();
-        });
+        return true;
+    }
+}
+
+template <bool CheckBreakpoints>
+bool virtual_cpu::impl_t::step(bool ignore_pause)
+{
+    // A pause() needs to break the run()-chain
+    if (state_ == virtual_cpu::execution_state::PAUSED && !ignore_pause) {
+        return false;
     }
+
+    if constexpr (CheckBreakpoints) {
+        if (bp_check(core.c)) {
+            return false;
+        }
+    }
+
+    const auto result = core.step(
+        [this]() { return read_input(); },
+        [this](char c) { write_output(c); });
+    return handle_step_result(result);
 }
 
 std::ostream& malbolge::operator<<(std::ostream& stream,
@@ -446,6 +891,24 @@ std::ostream& malbolge::operator<<(std::ostream& stream,
     }
 }
 
+std::ostream& malbolge::operator<<(std::ostream& stream,
+                                   virtual_cpu::engine_type engine)
+{
+    static_assert(static_cast<int>(virtual_cpu::engine_type::NUM_ENGINES) == 3,
+                  "Number of engines have changed, update operator<<");
+
+    switch (engine) {
+    case virtual_cpu::engine_type::STANDARD:
+        return stream << "STANDARD";
+    case virtual_cpu::engine_type::THREADED:
+        return stream << "THREADED";
+    case virtual_cpu::engine_type::FUSED:
+        return stream << "FUSED";
+    default:
+        return stream << "Unknown engine: " << static_cast<int>(engine);
+    }
+}
+
 std::ostream& malbolge::operator<<(std::ostream& stream,
                                    virtual_cpu::execution_state state)
 {
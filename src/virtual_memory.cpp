@@ -0,0 +1,120 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/virtual_memory.hpp"
+
+#include <algorithm>
+
+using namespace malbolge;
+
+namespace
+{
+// The longest cycle found when exhaustively testing all graphical ASCII cell
+// pairs (and a large random sample of all other pairs) is 6, this leaves some
+// headroom.  If a cycle is not found, the memory is still filled correctly -
+// just slower
+constexpr auto max_fill_period = virtual_memory::size_type{12};
+}
+
+void virtual_memory::fill(size_type pos) noexcept
+{
+    // Each cell depends only on the previous two, so as soon as a pair of cells
+    // repeats a pair computed p cells earlier the remainder of the memory is
+    // just that p-long cycle repeated.  The op recurrence enters such a cycle
+    // within a few cells, so rather than calculating the op ~59k times, we
+    // detect the cycle and then block copy it
+    auto& mem = *image_;
+    for (auto i = pos; i < mem.size(); ++i) {
+        mem[i] = mem[i-1].op(mem[i-2]);
+
+        // The cell after i must also have been generated by the op for the
+        // cycle to hold, hence the p limit
+        const auto max_p = std::min(max_fill_period, i + 1 - pos);
+        for (auto p = size_type{1}; p <= max_p; ++p) {
+            if (mem[i] != mem[i-p] || mem[i-1] != mem[i-1-p]) {
+                continue;
+            }
+
+            // Copy in doubling chunks, each chunk is always a whole number
+            // of cycles
+            auto dest = mem.begin() + i + 1;
+            for (auto chunk = p; dest != mem.end(); chunk *= 2) {
+                const auto n = std::min(chunk,
+                                        static_cast<size_type>(mem.end() - dest));
+                dest = std::copy(dest - chunk, dest - chunk + n, dest);
+            }
+            return;
+        }
+    }
+}
+
+void virtual_memory::map_image() noexcept
+{
+    flat_ = image_->data();
+    for (auto i = size_type{0}; i < num_pages; ++i) {
+        read_pages_[i] = write_pages_[i] = image_->data() + (i * page_size);
+    }
+}
+
+virtual_memory::reference virtual_memory::paged_at(size_type pos)
+{
+    const auto index = pos / page_size;
+    auto page = write_pages_[index];
+    if (!page) {
+        page = make_private(index);
+    }
+    return page[pos - (index * page_size)];
+}
+
+virtual_memory::const_reference virtual_memory::paged_at(size_type pos) const noexcept
+{
+    const auto index = pos / page_size;
+    return read_pages_[index][pos - (index * page_size)];
+}
+
+virtual_memory::pointer virtual_memory::make_private(size_type index)
+{
+    auto& page = owned_pages_.emplace_back(
+        std::make_unique_for_overwrite<value_type[]>(page_size));
+    std::copy_n(read_pages_[index], page_size, page.get());
+
+    read_pages_[index] = write_pages_[index] = page.get();
+    return page.get();
+}
+
+virtual_memory virtual_memory::clone()
+{
+    flat_ = nullptr;
+
+    auto copy = virtual_memory{};
+    copy.image_ = image_;
+    copy.read_pages_ = read_pages_;
+    copy.write_pages_.fill(nullptr);
+
+    for (auto i = size_type{0}; i < num_pages; ++i) {
+        if (!write_pages_[i]) {
+            continue;
+        }
+
+        if (write_pages_[i] == image_->data() + (i * page_size)) {
+            // The image is no longer private to this instance, so it becomes
+            // read-only
+            write_pages_[i] = nullptr;
+        } else {
+            // Pages already copied by this instance are specific to it, so
+            // the clone needs its own copy
+            copy.make_private(i);
+        }
+    }
+
+    return copy;
+}
+
+virtual_memory::size_type virtual_memory::num_private_pages() const noexcept
+{
+    return static_cast<size_type>(std::count_if(write_pages_.begin(),
+                                                write_pages_.end(),
+                                                [](auto page) { return page; }));
+}
@@ -0,0 +1,108 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/batch_executor.hpp"
+#include "malbolge/loader.hpp"
+
+#include "test_helpers.hpp"
+
+using namespace malbolge;
+using namespace std::string_literals;
+
+BOOST_AUTO_TEST_SUITE(batch_executor_suite)
+
+BOOST_AUTO_TEST_CASE(size)
+{
+    BOOST_CHECK_EQUAL(batch_executor{3}.size(), 3);
+    BOOST_CHECK_GT(batch_executor{}.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(empty)
+{
+    auto executor = batch_executor{2};
+    BOOST_CHECK(executor.run({}).empty());
+}
+
+BOOST_AUTO_TEST_CASE(run)
+{
+    auto executor = batch_executor{4};
+
+    // Run more than once to check that the pool is reusable
+    for (auto batch = 0u; batch < 3; ++batch) {
+        auto jobs = std::vector<batch_executor::job>{};
+        for (auto i = 0u; i < 50; ++i) {
+            jobs.push_back({load(std::filesystem::path{"programs/hello_world.mal"}), ""});
+            jobs.push_back({load(std::filesystem::path{"programs/echo.mal"}),
+                            "Hello "s + std::to_string(i) + "\n"});
+        }
+        jobs.push_back({virtual_memory(std::vector<int>{0, 0}), ""});
+
+        const auto results = executor.run(std::move(jobs));
+        BOOST_REQUIRE_EQUAL(results.size(), 101);
+
+        for (auto i = 0u; i < 50; ++i) {
+            const auto& hello = results[i * 2];
+            BOOST_CHECK_EQUAL(hello.output, "Hello World!");
+            BOOST_CHECK_EQUAL(hello.state, virtual_cpu::execution_state::STOPPED);
+            BOOST_CHECK(!hello.error);
+            BOOST_CHECK_GT(hello.steps, 0);
+
+            const auto& echo = results[(i * 2) + 1];
+            BOOST_CHECK_EQUAL(echo.output, "Hello "s + std::to_string(i) + "\n");
+            BOOST_CHECK_EQUAL(echo.state,
+                              virtual_cpu::execution_state::WAITING_FOR_INPUT);
+            BOOST_CHECK(!echo.error);
+        }
+
+        const auto& invalid = results.back();
+        BOOST_CHECK(invalid.output.empty());
+        BOOST_CHECK_EQUAL(invalid.state, virtual_cpu::execution_state::STOPPED);
+        BOOST_CHECK(invalid.error);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(limits)
+{
+    auto executor = batch_executor{2};
+
+    auto f = [&](auto limits, auto expected_limit, auto expected_output) {
+        auto jobs = std::vector<batch_executor::job>{};
+        jobs.push_back({load(std::filesystem::path{"programs/hello_world.mal"}),
+                        "",
+                        limits});
+
+        const auto results = executor.run(std::move(jobs));
+        BOOST_REQUIRE_EQUAL(results.size(), 1);
+
+        const auto& r = results.front();
+        BOOST_CHECK_EQUAL(r.output, expected_output);
+        BOOST_CHECK_EQUAL(r.state, virtual_cpu::execution_state::STOPPED);
+        BOOST_REQUIRE(r.error);
+        try {
+            std::rethrow_exception(r.error);
+        } catch (limit_exception& e) {
+            BOOST_CHECK_EQUAL(e.type(), expected_limit);
+            BOOST_CHECK_EQUAL(e.step(), r.steps);
+        }
+    };
+
+    const auto past = std::chrono::steady_clock::now();
+    test::data_set(
+        f,
+        {
+            std::tuple{execution_limits{10},
+                       execution_limits::limit_type::STEPS,
+                       "H"s},
+            std::tuple{execution_limits{.max_output = 5},
+                       execution_limits::limit_type::OUTPUT,
+                       "Hello"s},
+            std::tuple{execution_limits{.deadline = past},
+                       execution_limits::limit_type::DEADLINE,
+                       ""s},
+        }
+    );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
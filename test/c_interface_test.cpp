@@ -445,6 +445,9 @@ BOOST_FIXTURE_TEST_CASE(vcpu_nulls, fixture)
     result = malbolge_vcpu_step(nullptr);
     BOOST_CHECK_EQUAL(result, MALBOLGE_ERR_NULL_ARG);
 
+    result = malbolge_vcpu_set_limits(nullptr, 0, 0, 0);
+    BOOST_CHECK_EQUAL(result, MALBOLGE_ERR_NULL_ARG);
+
     {
         auto buffer = "hello";
         auto result = malbolge_vcpu_add_input(nullptr, buffer, 6);
@@ -739,6 +742,106 @@ BOOST_FIXTURE_TEST_CASE(echo, fixture)
     BOOST_CHECK(expected_states.empty());
 }
 
+BOOST_FIXTURE_TEST_CASE(instruction_limit, fixture)
+{
+    auto buffer = load_program_from_disk(std::filesystem::path{"programs/hello_world.mal"});
+    auto fail_line = 0u;
+    auto fail_column = 0u;
+    auto vmem = malbolge_load_program(buffer.data(),
+                                      buffer.size(),
+                                      MALBOLGE_LOAD_NORMALISED_AUTO,
+                                      &fail_line,
+                                      &fail_column);
+    BOOST_REQUIRE(vmem);
+
+    vcpu = malbolge_create_vcpu(vmem);
+    BOOST_REQUIRE(vcpu);
+
+    auto result = malbolge_vcpu_attach_callbacks(vcpu,
+                                                 state_cb,
+                                                 output_cb,
+                                                 breakpoint_cb);
+    BOOST_CHECK_EQUAL(result, MALBOLGE_ERR_SUCCESS);
+
+    expected_states = {
+        MALBOLGE_VCPU_PAUSED,
+        MALBOLGE_VCPU_STOPPED
+    };
+
+    result = malbolge_vcpu_set_limits(vcpu, 1, 0, 0);
+    BOOST_CHECK_EQUAL(result, MALBOLGE_ERR_SUCCESS);
+
+    result = malbolge_vcpu_step(vcpu);
+    BOOST_CHECK_EQUAL(result, MALBOLGE_ERR_SUCCESS);
+    {
+        auto lock = std::unique_lock{mtx};
+        BOOST_CHECK(cv.wait_for(lock, 100ms, [&]() { return paused; }));
+    }
+
+    expected_ec = MALBOLGE_ERR_STEP_LIMIT;
+    result = malbolge_vcpu_step(vcpu);
+    BOOST_CHECK_EQUAL(result, MALBOLGE_ERR_SUCCESS);
+    {
+        auto lock = std::unique_lock{mtx};
+        BOOST_CHECK(cv.wait_for(lock, 100ms, [&]() { return stopped; }));
+    }
+
+    BOOST_CHECK_EQUAL(output_str, "");
+    BOOST_CHECK(expected_states.empty());
+
+    malbolge_free_vcpu(vcpu);
+}
+
+BOOST_FIXTURE_TEST_CASE(deadline, fixture)
+{
+    auto buffer = load_program_from_disk(std::filesystem::path{"programs/echo.mal"});
+    auto fail_line = 0u;
+    auto fail_column = 0u;
+    auto vmem = malbolge_load_program(buffer.data(),
+                                      buffer.size(),
+                                      MALBOLGE_LOAD_NORMALISED_AUTO,
+                                      &fail_line,
+                                      &fail_column);
+    BOOST_REQUIRE(vmem);
+
+    vcpu = malbolge_create_vcpu(vmem);
+    BOOST_REQUIRE(vcpu);
+
+    auto result = malbolge_vcpu_attach_callbacks(vcpu,
+                                                 state_cb,
+                                                 output_cb,
+                                                 breakpoint_cb);
+    BOOST_CHECK_EQUAL(result, MALBOLGE_ERR_SUCCESS);
+
+    expected_states = {
+        MALBOLGE_VCPU_RUNNING,
+        MALBOLGE_VCPU_WAITING_FOR_INPUT,
+        MALBOLGE_VCPU_STOPPED
+    };
+
+    // The deadline applies whilst waiting for input too
+    result = malbolge_vcpu_set_limits(vcpu, 0, 200, 0);
+    BOOST_CHECK_EQUAL(result, MALBOLGE_ERR_SUCCESS);
+
+    result = malbolge_vcpu_run(vcpu);
+    BOOST_CHECK_EQUAL(result, MALBOLGE_ERR_SUCCESS);
+    {
+        auto lock = std::unique_lock{mtx};
+        BOOST_CHECK(cv.wait_for(lock, 100ms, [&]() { return waiting; }));
+        expected_ec = MALBOLGE_ERR_DEADLINE;
+    }
+
+    {
+        auto lock = std::unique_lock{mtx};
+        BOOST_CHECK(cv.wait_for(lock, 1s, [&]() { return stopped; }));
+    }
+
+    BOOST_CHECK_EQUAL(output_str, "");
+    BOOST_CHECK(expected_states.empty());
+
+    malbolge_free_vcpu(vcpu);
+}
+
 BOOST_FIXTURE_TEST_CASE(invalid_register_value_query, fixture)
 {
     auto buffer = load_program_from_disk(std::filesystem::path{"programs/hello_world.mal"});
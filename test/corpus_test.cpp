@@ -0,0 +1,170 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/corpus.hpp"
+#include "malbolge/exception.hpp"
+#include "malbolge/utility/raii.hpp"
+
+#include "test_helpers.hpp"
+
+#include <fstream>
+
+using namespace malbolge;
+
+namespace
+{
+std::string read_file(const std::filesystem::path& path)
+{
+    auto stream = std::ifstream{path, std::ios::binary};
+    return {std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+}
+
+void write_file(const std::filesystem::path& path, const std::string& data)
+{
+    std::filesystem::create_directories(path.parent_path());
+    auto stream = std::ofstream{path, std::ios::binary};
+    stream << data;
+}
+}
+
+BOOST_AUTO_TEST_SUITE(corpus_suite)
+
+BOOST_AUTO_TEST_CASE(corpus_operation_streaming_operator)
+{
+    auto f = [](auto op, auto expected) {
+        auto ss = std::stringstream{};
+        ss << op;
+        BOOST_CHECK_EQUAL(ss.str(), expected);
+    };
+
+    test::data_set(
+        f,
+        {
+            std::tuple{corpus_operation::VALIDATE, "validate"},
+            std::tuple{corpus_operation::NORMALISE, "normalise"},
+            std::tuple{corpus_operation::DENORMALISE, "denormalise"},
+            std::tuple{static_cast<corpus_operation>(42), "Unknown corpus operation: 42"},
+        }
+    );
+}
+
+BOOST_AUTO_TEST_CASE(process)
+{
+    const auto root = std::filesystem::temp_directory_path() / "malbolge_corpus_test";
+    std::filesystem::remove_all(root);
+    auto cleanup = utility::raii{[&]() { std::filesystem::remove_all(root); }};
+
+    const auto hello_world = read_file("programs/hello_world.mal");
+    auto hello_world_normalised = read_file("programs/hello_world_normalised.mal");
+    hello_world_normalised.pop_back();  // Trailing newline
+
+    const auto input = root / "input";
+    write_file(input / "hello_world.mal", hello_world);
+    write_file(input / "sub" / "hello_world.mal", hello_world);
+    write_file(input / "sub" / "invalid.mal", "hello");
+    write_file(input / "ignored.txt", "hello");
+
+    BOOST_TEST_MESSAGE("Validate");
+    {
+        const auto results = process_corpus({input}, corpus_operation::VALIDATE, {}, 2);
+        BOOST_REQUIRE_EQUAL(results.size(), 3);
+        BOOST_CHECK_EQUAL(results[0].path, input / "hello_world.mal");
+        BOOST_CHECK(!results[0].error);
+        BOOST_CHECK_EQUAL(results[1].path, input / "sub" / "hello_world.mal");
+        BOOST_CHECK(!results[1].error);
+        BOOST_CHECK_EQUAL(results[2].path, input / "sub" / "invalid.mal");
+        BOOST_CHECK(results[2].error);
+    }
+
+    BOOST_TEST_MESSAGE("Normalise");
+    {
+        const auto output = root / "normalised";
+        const auto results = process_corpus({input}, corpus_operation::NORMALISE, output, 2);
+        BOOST_REQUIRE_EQUAL(results.size(), 3);
+        BOOST_CHECK(!results[0].error);
+        BOOST_CHECK(!results[1].error);
+        BOOST_CHECK(results[2].error);
+
+        BOOST_CHECK_EQUAL(read_file(output / "hello_world.mal"), hello_world_normalised);
+        BOOST_CHECK_EQUAL(read_file(output / "sub" / "hello_world.mal"),
+                          hello_world_normalised);
+        BOOST_CHECK(!std::filesystem::exists(output / "sub" / "invalid.mal"));
+        BOOST_CHECK(!std::filesystem::exists(output / "ignored.txt"));
+    }
+
+    BOOST_TEST_MESSAGE("Denormalise");
+    {
+        const auto output = root / "denormalised";
+        const auto results = process_corpus({root / "normalised"},
+                                            corpus_operation::DENORMALISE,
+                                            output);
+        BOOST_REQUIRE_EQUAL(results.size(), 2);
+        BOOST_CHECK(!results[0].error);
+        BOOST_CHECK(!results[1].error);
+
+        // The trailing newline is dropped
+        const auto expected = hello_world.substr(0, hello_world.size()-1);
+        BOOST_CHECK_EQUAL(read_file(output / "hello_world.mal"), expected);
+        BOOST_CHECK_EQUAL(read_file(output / "sub" / "hello_world.mal"), expected);
+    }
+
+    BOOST_TEST_MESSAGE("Output collision");
+    {
+        // Both input directories have a hello_world.mal at the top level
+        const auto other = root / "other";
+        write_file(other / "hello_world.mal", hello_world);
+        write_file(other / "unique" / "hello_world.mal", hello_world);
+
+        const auto output = root / "collision";
+        const auto results = process_corpus({input, other},
+                                            corpus_operation::NORMALISE,
+                                            output,
+                                            2);
+        BOOST_REQUIRE_EQUAL(results.size(), 5);
+        auto check_collision = [](const corpus_file_result& r) {
+            BOOST_REQUIRE(r.error);
+            try {
+                std::rethrow_exception(r.error);
+            } catch (system_exception& e) {
+                BOOST_CHECK_EQUAL(e.code().value(),
+                                  static_cast<int>(std::errc::file_exists));
+            }
+        };
+
+        BOOST_CHECK_EQUAL(results[0].path, input / "hello_world.mal");
+        check_collision(results[0]);
+        BOOST_CHECK(!results[1].error);
+        BOOST_CHECK(results[2].error);
+        BOOST_CHECK_EQUAL(results[3].path, other / "hello_world.mal");
+        check_collision(results[3]);
+        BOOST_CHECK(!results[4].error);
+
+        BOOST_CHECK(!std::filesystem::exists(output / "hello_world.mal"));
+        BOOST_CHECK_EQUAL(read_file(output / "unique" / "hello_world.mal"),
+                          hello_world_normalised);
+
+        // Validation doesn't write, so there's nothing to collide
+        const auto validated = process_corpus({input, other},
+                                              corpus_operation::VALIDATE);
+        BOOST_CHECK(!validated[0].error);
+    }
+
+    BOOST_TEST_MESSAGE("Errors");
+    try {
+        [[maybe_unused]] auto results = process_corpus({input}, corpus_operation::NORMALISE);
+        BOOST_FAIL("Should have thrown");
+    } catch (system_exception& e) {
+        BOOST_CHECK_EQUAL(e.code().value(),
+                          static_cast<int>(std::errc::invalid_argument));
+    }
+
+    try {
+        [[maybe_unused]] auto results = process_corpus({root / "missing"},
+                                                       corpus_operation::VALIDATE);
+        BOOST_FAIL("Should have thrown");
+    } catch (system_exception&) {}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
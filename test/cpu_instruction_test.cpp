@@ -4,6 +4,7 @@
  */
 
 #include "malbolge/cpu_instruction.hpp"
+#include "malbolge/math/ternary.hpp"
 
 #include "test_helpers.hpp"
 
@@ -132,4 +133,88 @@ BOOST_AUTO_TEST_CASE(post_cipher_instruction_test)
     );
 }
 
+BOOST_AUTO_TEST_CASE(opcode_streaming_operator)
+{
+    auto f = [](auto code, auto expected) {
+        auto ss = std::stringstream{};
+        ss << code;
+        BOOST_CHECK_EQUAL(ss.str(), expected);
+    };
+
+    test::data_set(
+        f,
+        {
+            std::tuple{cpu_instruction::opcode::set_data_ptr,   "j"},
+            std::tuple{cpu_instruction::opcode::nop,            "o"},
+            std::tuple{cpu_instruction::opcode::unknown,        "unknown"},
+            std::tuple{cpu_instruction::opcode::invalid,        "invalid"},
+            std::tuple{static_cast<cpu_instruction::opcode>(42), "Unknown opcode: 42"},
+        }
+    );
+}
+
+BOOST_AUTO_TEST_CASE(to_type)
+{
+    for (auto i = 0u; i < cpu_instruction::all.size(); ++i) {
+        const auto code = static_cast<cpu_instruction::opcode>(i);
+        BOOST_CHECK_EQUAL(cpu_instruction::to_type(code),
+                          cpu_instruction::all[i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(pre_cipher_decode_test)
+{
+    // Check against the optional-based version for every input and index
+    // within a cycle, plus a few more to check the index wrapping
+    for (auto input = std::numeric_limits<char>::min();
+         input < std::numeric_limits<char>::max(); ++input) {
+        for (auto index = 0u; index < (cipher::size * 2) + 3; ++index) {
+            const auto result = pre_cipher_decode(input, index);
+            const auto expected = pre_cipher_instruction(input, index);
+            if (!expected) {
+                BOOST_CHECK_EQUAL(result, cpu_instruction::opcode::invalid);
+            } else if (!is_cpu_instruction(*expected)) {
+                BOOST_CHECK_EQUAL(result, cpu_instruction::opcode::unknown);
+            } else {
+                BOOST_CHECK_EQUAL(cpu_instruction::to_type(result), *expected);
+            }
+        }
+    }
+
+    BOOST_CHECK_EQUAL(pre_cipher_decode(math::ternary{'('}, 0),
+                      cpu_instruction::opcode::set_data_ptr);
+    BOOST_CHECK_EQUAL(pre_cipher_decode(math::ternary{1000}, 0),
+                      cpu_instruction::opcode::invalid);
+}
+
+BOOST_AUTO_TEST_CASE(post_cipher_encode_test)
+{
+    for (auto input = std::numeric_limits<char>::min();
+         input < std::numeric_limits<char>::max(); ++input) {
+        const auto result = post_cipher_encode(input);
+        const auto expected = post_cipher_instruction(input);
+        BOOST_CHECK_EQUAL(result, expected.value_or(cipher::invalid));
+    }
+
+    BOOST_CHECK_EQUAL(post_cipher_encode(math::ternary{'a'}), '.');
+    BOOST_CHECK_EQUAL(post_cipher_encode(math::ternary{1000}), cipher::invalid);
+}
+
+BOOST_AUTO_TEST_CASE(cipher_transition_test)
+{
+    // Check against the separate decode and encode for every input and index
+    for (auto input = std::numeric_limits<char>::min();
+         input < std::numeric_limits<char>::max(); ++input) {
+        for (auto index = 0u; index < cipher::size; ++index) {
+            const auto result = cipher_transition(input, index);
+            BOOST_CHECK_EQUAL(result.instr, pre_cipher_decode(input, index));
+            BOOST_CHECK_EQUAL(result.encrypted, post_cipher_encode(input));
+        }
+    }
+
+    const auto result = cipher_transition(math::ternary{1000}, 0);
+    BOOST_CHECK_EQUAL(result.instr, cpu_instruction::opcode::invalid);
+    BOOST_CHECK_EQUAL(result.encrypted, cipher::invalid);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,169 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/execute.hpp"
+#include "malbolge/loader.hpp"
+
+#include "test_helpers.hpp"
+
+using namespace malbolge;
+using namespace std::string_literals;
+
+BOOST_AUTO_TEST_SUITE(execute_suite)
+
+BOOST_AUTO_TEST_CASE(hello_world)
+{
+    auto output = ""s;
+    const auto result = execute(load(std::filesystem::path{"programs/hello_world.mal"}),
+                                "",
+                                output);
+    BOOST_CHECK_EQUAL(result.state, execution_result::status::STOPPED);
+    BOOST_CHECK_GT(result.steps, 0);
+    BOOST_CHECK_EQUAL(output, "Hello World!");
+}
+
+BOOST_AUTO_TEST_CASE(echo)
+{
+    auto f = [](auto input, auto expected_output) {
+        auto output = ""s;
+        const auto result = execute(load(std::filesystem::path{"programs/echo.mal"}),
+                                    input,
+                                    [&](char c) { output.push_back(c); });
+        BOOST_CHECK_EQUAL(result.state,
+                          execution_result::status::WAITING_FOR_INPUT);
+        BOOST_CHECK_EQUAL(output, expected_output);
+    };
+
+    test::data_set(
+        f,
+        {
+            std::tuple{""s,                 ""s},
+            std::tuple{"Hello\n"s,          "Hello\n"s},
+            std::tuple{"Hello\nWorld\n"s,   "Hello\nWorld\n"s},
+            std::tuple{"Hello\0World\n"s,   "Hello"s},
+        }
+    );
+}
+
+BOOST_AUTO_TEST_CASE(step_limit)
+{
+    auto output = ""s;
+    const auto result = execute(load(std::filesystem::path{"programs/hello_world.mal"}),
+                                "",
+                                output,
+                                {.max_steps = 10});
+    BOOST_CHECK_EQUAL(result.state, execution_result::status::LIMIT_REACHED);
+    BOOST_REQUIRE(result.limit);
+    BOOST_CHECK_EQUAL(*result.limit, execution_limits::limit_type::STEPS);
+    BOOST_CHECK_EQUAL(result.steps, 10);
+}
+
+BOOST_AUTO_TEST_CASE(output_limit)
+{
+    auto f = [](auto max_output, auto expected_state, auto expected_output) {
+        auto output = ""s;
+        const auto result = execute(load(std::filesystem::path{"programs/hello_world.mal"}),
+                                    "",
+                                    output,
+                                    {.max_output = max_output});
+        BOOST_CHECK_EQUAL(result.state, expected_state);
+        BOOST_CHECK_EQUAL(output, expected_output);
+        if (expected_state == execution_result::status::LIMIT_REACHED) {
+            BOOST_REQUIRE(result.limit);
+            BOOST_CHECK_EQUAL(*result.limit, execution_limits::limit_type::OUTPUT);
+        } else {
+            BOOST_CHECK(!result.limit);
+        }
+    };
+
+    test::data_set(
+        f,
+        {
+            std::tuple{std::size_t{0},  execution_result::status::LIMIT_REACHED,    ""s},
+            std::tuple{std::size_t{5},  execution_result::status::LIMIT_REACHED,    "Hello"s},
+            std::tuple{std::size_t{12}, execution_result::status::STOPPED,          "Hello World!"s},
+        }
+    );
+}
+
+BOOST_AUTO_TEST_CASE(deadline)
+{
+    auto f = [](auto deadline, auto expected_state) {
+        auto output = ""s;
+        auto limits = execution_limits{};
+        limits.deadline = deadline;
+
+        const auto result = execute(load(std::filesystem::path{"programs/echo.mal"}),
+                                    std::string(10'000, 'a'),
+                                    output,
+                                    limits);
+        BOOST_CHECK_EQUAL(result.state, expected_state);
+        if (expected_state == execution_result::status::LIMIT_REACHED) {
+            BOOST_REQUIRE(result.limit);
+            BOOST_CHECK_EQUAL(*result.limit, execution_limits::limit_type::DEADLINE);
+            BOOST_CHECK_EQUAL(result.steps, 0);
+        }
+    };
+
+    const auto now = std::chrono::steady_clock::now();
+    test::data_set(
+        f,
+        {
+            std::tuple{now,                             execution_result::status::LIMIT_REACHED},
+            std::tuple{now + std::chrono::hours{1},     execution_result::status::WAITING_FOR_INPUT},
+        }
+    );
+}
+
+BOOST_AUTO_TEST_CASE(invalid_program)
+{
+    auto output = ""s;
+    try {
+        execute(virtual_memory(std::vector<int>{0, 0}), "", output);
+        BOOST_FAIL("Should have thrown");
+    } catch (execution_exception& e) {
+        BOOST_CHECK_EQUAL(e.step(), 0);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(status_streaming)
+{
+    auto f = [](auto status, auto expected) {
+        auto ss = std::stringstream{};
+        ss << status;
+        BOOST_CHECK_EQUAL(ss.str(), expected);
+    };
+
+    test::data_set(
+        f,
+        {
+            std::tuple{execution_result::status::STOPPED,           "STOPPED"},
+            std::tuple{execution_result::status::WAITING_FOR_INPUT, "WAITING_FOR_INPUT"},
+            std::tuple{execution_result::status::LIMIT_REACHED,     "LIMIT_REACHED"},
+            std::tuple{execution_result::status::NUM_STATUSES,      "Unknown execution status: 3"},
+        }
+    );
+}
+
+BOOST_AUTO_TEST_CASE(limit_type_streaming)
+{
+    auto f = [](auto type, auto expected) {
+        auto ss = std::stringstream{};
+        ss << type;
+        BOOST_CHECK_EQUAL(ss.str(), expected);
+    };
+
+    test::data_set(
+        f,
+        {
+            std::tuple{execution_limits::limit_type::STEPS,         "STEPS"},
+            std::tuple{execution_limits::limit_type::OUTPUT,        "OUTPUT"},
+            std::tuple{execution_limits::limit_type::DEADLINE,      "DEADLINE"},
+            std::tuple{execution_limits::limit_type::NUM_LIMITS,    "Unknown limit type: 3"},
+        }
+    );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -11,6 +11,7 @@
 #include <fstream>
 
 using namespace malbolge;
+using namespace std::string_literals;
 
 BOOST_AUTO_TEST_SUITE(loader_suite)
 
@@ -155,10 +156,192 @@ BOOST_AUTO_TEST_CASE(load_test)
                     {40, 39},
                     false,
                     optional_source_location{}},
+            pdata_t{{40, '\n', ' ', '\n', ' ', ' ', 1},
+                    {},
+                    true,
+                    optional_source_location{source_location{3, 3}}},
+        }
+    );
+}
+
+BOOST_AUTO_TEST_CASE(source_validator_test)
+{
+    auto f = [](auto chunks, auto expected, auto loc) {
+        auto validator = malbolge::detail::source_validator{};
+        auto output = std::string{};
+        try {
+            for (auto chunk : chunks) {
+                validator(chunk.begin(), chunk.end(), std::back_inserter(output));
+            }
+            if (loc) {
+                BOOST_FAIL("Should have thrown");
+            }
+
+            BOOST_CHECK_EQUAL(output, expected);
+            BOOST_CHECK_EQUAL(validator.size(), expected.size());
+        } catch (parse_exception& e) {
+            BOOST_TEST_MESSAGE(e.what());
+            if (!loc) {
+                BOOST_FAIL("Should not have thrown");
+            }
+            BOOST_CHECK_EQUAL(e.location(), loc);
+        }
+    };
+
+    test::data_set(
+        f,
+        {
+            std::tuple{std::vector<std::string>{"(=<`#9]~6ZY32Vx/4Rs+0No-&Jk)\"Fh}|Bcy?`=*z]Kw%oG4UUS0/@-ejc(:'8dc"},
+                       std::string{"(=<`#9]~6ZY32Vx/4Rs+0No-&Jk)\"Fh}|Bcy?`=*z]Kw%oG4UUS0/@-ejc(:'8dc"},
+                       optional_source_location{}},
+            std::tuple{std::vector<std::string>{"(=<`#9]~6ZY32V\nx/4Rs+0No", "-&Jk)\"Fh}|\n  Bcy?`=*z]Kw%oG4UUS0/@-ejc(:'8dc"},
+                       std::string{"(=<`#9]~6ZY32Vx/4Rs+0No-&Jk)\"Fh}|Bcy?`=*z]Kw%oG4UUS0/@-ejc(:'8dc"},
+                       optional_source_location{}},
+            std::tuple{std::vector<std::string>{"(=<\n  \t", "\n `", "#9\x01"},
+                       std::string{""},
+                       optional_source_location{source_location{3, 5}}},
+            std::tuple{std::vector<std::string>{"(=<\n", "\n", "(("},
+                       std::string{""},
+                       optional_source_location{source_location{3, 1}}},
         }
     );
 }
 
+BOOST_AUTO_TEST_CASE(load_from_stream_chunked)
+{
+    // Larger than the stream chunk size, so spans multiple chunks
+    auto normalised = std::string(10000, 'o');
+    normalised.back() = 'v';
+    auto denormalised = normalised;
+    denormalise_source(denormalised);
+
+    auto wrapped = std::string{};
+    for (auto i = 0u; i < denormalised.size(); ++i) {
+        if (i && (i % 80) == 0) {
+            wrapped.push_back('\n');
+        }
+        wrapped.push_back(denormalised[i]);
+    }
+
+    auto f = [&](auto source, auto mode) {
+        auto ss = std::stringstream{source};
+        const auto vmem = load_from_stream(ss, mode);
+        for (auto i = 0u; i < denormalised.size(); ++i) {
+            BOOST_REQUIRE_EQUAL(vmem[i], denormalised[i]);
+        }
+    };
+
+    test::data_set(
+        f,
+        {
+            std::tuple{wrapped,             load_normalised_mode::AUTO},
+            std::tuple{wrapped,             load_normalised_mode::OFF},
+            std::tuple{normalised + "\n\n", load_normalised_mode::AUTO},
+            std::tuple{normalised,          load_normalised_mode::ON},
+        }
+    );
+
+    BOOST_TEST_MESSAGE("Error location in a later chunk");
+    auto bad = wrapped;
+    bad[bad.size() - 3] = '\x01';
+    try {
+        auto ss = std::stringstream{bad};
+        auto vmem = load_from_stream(ss, load_normalised_mode::AUTO);
+        BOOST_FAIL("Should have thrown");
+    } catch (parse_exception& e) {
+        const auto expected_line = 1 + (denormalised.size() - 1) / 80;
+        BOOST_REQUIRE(e.location());
+        BOOST_CHECK_EQUAL(e.location()->line, expected_line);
+        BOOST_CHECK_EQUAL(e.location()->column, 80 - 2);
+    }
+
+    BOOST_TEST_MESSAGE("Invalid normalised program");
+    {
+        // Must fail like the range version, rather than load unvalidated
+        auto f = [](auto source) {
+            auto expected = optional_source_location{};
+            try {
+                auto data = source;
+                auto vmem = load(data, load_normalised_mode::ON);
+                BOOST_FAIL("Range version should have thrown");
+            } catch (parse_exception& e) {
+                expected = e.location();
+            }
+
+            try {
+                auto ss = std::stringstream{source};
+                auto vmem = load_from_stream(ss, load_normalised_mode::ON);
+                BOOST_FAIL("Should have thrown");
+            } catch (parse_exception& e) {
+                BOOST_TEST_MESSAGE(e.what());
+                BOOST_REQUIRE(expected);
+                BOOST_CHECK_EQUAL(e.location(), expected);
+            }
+        };
+
+        auto later_chunk = normalised;
+        later_chunk[later_chunk.size() - 3] = 'Z';
+        auto later_whitespace = normalised;
+        later_whitespace[5000] = ' ';
+
+        test::data_set(
+            f,
+            {
+                std::tuple{"j\x01j"s},
+                std::tuple{"jj j"s},
+                std::tuple{"jjZ"s},
+                std::tuple{"jj\n \njj\n"s},
+                std::tuple{later_chunk},
+                std::tuple{later_whitespace},
+            }
+        );
+    }
+
+    BOOST_TEST_MESSAGE("Too long");
+    {
+        // The first character past the memory space is reported, even if
+        // validation has already stopped
+        constexpr auto overflow = math::ternary::underlying_type{math::ternary::max + 1u};
+        auto long_denormalised = std::string(overflow + 1, 'o');
+        denormalise_source(long_denormalised);
+
+        auto long_wrapped = std::string{};
+        for (auto i = 0u; i <= overflow; ++i) {
+            if (i && (i % 80) == 0) {
+                long_wrapped.push_back('\n');
+            }
+            long_wrapped.push_back(long_denormalised[i]);
+        }
+
+        auto f = [](auto source, auto mode, auto expected_loc) {
+            try {
+                auto ss = std::stringstream{source};
+                auto vmem = load_from_stream(ss, mode);
+                BOOST_FAIL("Should have thrown");
+            } catch (parse_exception& e) {
+                BOOST_TEST_MESSAGE(e.what());
+                BOOST_CHECK_EQUAL(e.location(), expected_loc);
+            }
+        };
+
+        test::data_set(
+            f,
+            {
+                std::tuple{std::string(overflow + 1, 'o'),
+                           load_normalised_mode::AUTO,
+                           optional_source_location{source_location{1, overflow + 1}}},
+                std::tuple{std::string(overflow + 1, 'o'),
+                           load_normalised_mode::ON,
+                           optional_source_location{source_location{1, overflow + 1}}},
+                std::tuple{long_wrapped,
+                           load_normalised_mode::OFF,
+                           optional_source_location{source_location{1 + overflow / 80,
+                                                                    1 + overflow % 80}}},
+            }
+        );
+    }
+}
+
 BOOST_AUTO_TEST_CASE(bad_file_path)
 {
     try {
@@ -4,6 +4,7 @@
  */
 
 #include "malbolge/log.hpp"
+#include "malbolge/utility/raii.hpp"
 
 #include "test_helpers.hpp"
 
@@ -54,4 +55,45 @@ BOOST_AUTO_TEST_CASE(colour_to_ansi)
     );
 }
 
+BOOST_AUTO_TEST_CASE(print)
+{
+    // Redirect clog so the output can be checked
+    auto ss = std::stringstream{};
+    auto old_buf = std::clog.rdbuf(ss.rdbuf());
+    const auto old_level = log::log_level();
+    auto restore = utility::raii{[&]() {
+        std::clog.rdbuf(old_buf);
+        log::set_log_level(old_level);
+    }};
+
+    if constexpr (log::log_level_floor > log::DEBUG) {
+        BOOST_TEST_MESSAGE("Log level floor too high to test");
+        return;
+    }
+
+    log::set_log_level(log::INFO);
+    log::print(log::DEBUG, "runtime debug");
+    log::print<log::DEBUG>("compile-time debug");
+    log::print<log::INFO>("compile-time info");
+    BOOST_CHECK(ss.str().find("runtime debug") == std::string::npos);
+    BOOST_CHECK(ss.str().find("compile-time debug") == std::string::npos);
+    BOOST_CHECK(ss.str().find("[INFO]: compile-time info") != std::string::npos);
+
+    BOOST_TEST_MESSAGE("Lazy print");
+    auto called = false;
+    auto fn = [&]() {
+        called = true;
+        return std::tuple{"lazy ", 42};
+    };
+
+    log::print_lazy<log::DEBUG>(fn);
+    BOOST_CHECK(!called);
+    BOOST_CHECK(ss.str().find("lazy") == std::string::npos);
+
+    log::set_log_level(log::DEBUG);
+    log::print_lazy<log::DEBUG>(fn);
+    BOOST_CHECK(called);
+    BOOST_CHECK(ss.str().find("[DEBUG]: lazy 42") != std::string::npos);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
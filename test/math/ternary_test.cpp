@@ -16,6 +16,7 @@ BOOST_AUTO_TEST_CASE(default_constructor)
 {
     BOOST_CHECK_EQUAL(math::ternary{}, 0u);
     BOOST_CHECK_EQUAL(math::ternary::max, 59048u);
+    BOOST_CHECK_EQUAL(sizeof(math::ternary), sizeof(math::ternary::storage_type));
 }
 
 BOOST_AUTO_TEST_CASE(constructor)
@@ -36,6 +37,24 @@ BOOST_AUTO_TEST_CASE(constructor)
     );
 }
 
+BOOST_AUTO_TEST_CASE(backend_streaming_operator)
+{
+    auto f = [](auto input, auto expected) {
+        auto ss = std::stringstream{};
+        ss << input;
+        BOOST_CHECK_EQUAL(ss.str(), expected);
+    };
+
+    test::data_set(
+        f,
+        {
+            std::tuple{math::ternary::backend::TRITWISE,     "TRITWISE"},
+            std::tuple{math::ternary::backend::TABLE,        "TABLE"},
+            std::tuple{math::ternary::backend::NUM_BACKENDS, "Unknown ternary backend: 2"},
+        }
+    );
+}
+
 BOOST_AUTO_TEST_CASE(streaming_operator)
 {
     auto f = [](auto input, auto expected) {
@@ -245,10 +264,29 @@ BOOST_AUTO_TEST_CASE(rotate)
     );
 }
 
+BOOST_AUTO_TEST_CASE(rotate_backends)
+{
+    for (auto v = 0u; v <= math::ternary::max; ++v) {
+        for (auto r = 0u; r <= math::ternary::tritset_type::width; ++r) {
+            auto tritwise = math::ternary{v};
+            auto table = math::ternary{v};
+
+            tritwise.rotate<math::ternary::backend::TRITWISE>(r);
+            table.rotate<math::ternary::backend::TABLE>(r);
+            if (tritwise != table) {
+                BOOST_CHECK_MESSAGE(false, "Mismatch for " << v << ", " << r);
+                return;
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(op)
 {
     auto f = [](math::ternary a, math::ternary b, math::ternary expected) {
         BOOST_CHECK_EQUAL(a.op(b), expected);
+        BOOST_CHECK_EQUAL(a.op<math::ternary::backend::TRITWISE>(b), expected);
+        BOOST_CHECK_EQUAL(a.op<math::ternary::backend::TABLE>(b), expected);
     };
 
     test::data_set(
@@ -266,4 +304,20 @@ BOOST_AUTO_TEST_CASE(op)
     );
 }
 
+BOOST_AUTO_TEST_CASE(op_backends)
+{
+    // Exhaustively checking all 59049^2 combinations takes too long, so use a
+    // prime stride for the second operand
+    for (auto a = 0u; a <= math::ternary::max; ++a) {
+        for (auto b = a % 997; b <= math::ternary::max; b += 997) {
+            const auto tritwise = math::ternary{a}.op<math::ternary::backend::TRITWISE>(b);
+            const auto table = math::ternary{a}.op<math::ternary::backend::TABLE>(b);
+            if (tritwise != table) {
+                BOOST_CHECK_MESSAGE(false, "Mismatch for " << a << ", " << b);
+                return;
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
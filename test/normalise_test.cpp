@@ -4,9 +4,13 @@
  */
 
 #include "malbolge/normalise.hpp"
+#include "malbolge/utility/raii.hpp"
 
 #include "test_helpers.hpp"
 
+#include <random>
+#include <variant>
+
 using namespace malbolge;
 using namespace std::string_literals;
 
@@ -241,4 +245,100 @@ BOOST_AUTO_TEST_CASE(is_likely_normalised_test)
     );
 }
 
+BOOST_AUTO_TEST_CASE(simd_level_test)
+{
+    // The vectorised kernels must produce identical results, and identical
+    // diagnostic locations, to the lookup tables
+    using result_type = std::variant<std::string, source_location>;
+
+    auto with_level = [](detail::simd_level level, auto&& fn) {
+        const auto prev = detail::active_simd_level();
+        auto restore = utility::raii{[&]() { detail::set_simd_level(prev); }};
+        detail::set_simd_level(level);
+        return fn();
+    };
+    auto normalise = [](auto source) -> result_type {
+        try {
+            normalise_source_resize(source);
+            return source;
+        } catch (parse_exception& e) {
+            return *e.location();
+        }
+    };
+    auto denormalise = [](auto source) -> result_type {
+        try {
+            denormalise_source_resize(source);
+            return source;
+        } catch (parse_exception& e) {
+            return *e.location();
+        }
+    };
+
+    auto gen = std::mt19937{42};
+    auto pick = [&](std::size_t n) {
+        return std::uniform_int_distribution<std::size_t>{0, n-1}(gen);
+    };
+
+    for (auto size : {0u, 1u, 15u, 16u, 17u, 31u, 32u, 33u, 100u, 1000u}) {
+        auto normalised = std::string(size, ' ');
+        for (auto& c : normalised) {
+            c = cpu_instruction::all[pick(cpu_instruction::all.size())];
+        }
+
+        auto source = normalised;
+        denormalise_source(source);
+
+        auto spaced = std::string{};
+        for (auto c : source) {
+            if (!pick(8)) {
+                spaced += " \n\t"[pick(3)];
+            }
+            spaced += c;
+        }
+
+        auto cases = std::vector{
+            std::tuple{source, normalised},
+            std::tuple{spaced, normalised},
+        };
+        if (size) {
+            for (auto bad : {'d', '\x7F', '\x01', '\xAA'}) {
+                auto pos = pick(size);
+                auto s = source;
+                s[pos] = bad;
+                auto n = normalised;
+                n[pos] = bad;
+                cases.emplace_back(std::move(s), std::move(n));
+            }
+        }
+
+        for (const auto& [src, norm] : cases) {
+            BOOST_TEST_MESSAGE("Size: " << size);
+
+            const auto expected_norm = with_level(detail::simd_level::NONE,
+                                                  [&]() { return normalise(src); });
+            const auto expected_denorm = with_level(detail::simd_level::NONE,
+                                                    [&]() { return denormalise(norm); });
+            const auto expected_likely = with_level(
+                detail::simd_level::NONE,
+                [&]() { return is_likely_normalised_source(norm); });
+
+            for (auto level = detail::simd_level::NONE;
+                 level <= detail::max_simd_level();
+                 level = static_cast<detail::simd_level>(
+                    static_cast<int>(level) + 1)) {
+                BOOST_TEST_MESSAGE("Level: " << static_cast<int>(level));
+
+                BOOST_CHECK(with_level(level, [&]() { return normalise(src); }) ==
+                            expected_norm);
+                BOOST_CHECK(with_level(level, [&]() { return denormalise(norm); }) ==
+                            expected_denorm);
+                BOOST_CHECK_EQUAL(
+                    with_level(level,
+                               [&]() { return is_likely_normalised_source(norm); }),
+                    expected_likely);
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -288,6 +288,57 @@ BOOST_AUTO_TEST_CASE(debugger_script_and_file)
     BOOST_CHECK_EQUAL(*(ap.debugger_script()), script);
 }
 
+BOOST_AUTO_TEST_CASE(corpus)
+{
+    {
+        auto ap = arg_dispatcher({"--corpus", "validate", "a", "b"});
+        BOOST_REQUIRE(ap.corpus());
+        BOOST_CHECK_EQUAL(ap.corpus()->op, corpus_operation::VALIDATE);
+        BOOST_CHECK_EQUAL(ap.corpus()->dirs.size(), 2);
+        BOOST_CHECK_EQUAL(ap.corpus()->dirs[0], "a");
+        BOOST_CHECK_EQUAL(ap.corpus()->dirs[1], "b");
+        BOOST_CHECK(!ap.corpus()->output_dir);
+        BOOST_CHECK_EQUAL(ap.log_level(), log::ERROR);
+    }
+
+    {
+        auto ap = arg_dispatcher({"-ll", "--output-dir", "out", "--corpus", "denormalise", "a"});
+        BOOST_REQUIRE(ap.corpus());
+        BOOST_CHECK_EQUAL(ap.corpus()->op, corpus_operation::DENORMALISE);
+        BOOST_CHECK_EQUAL(ap.corpus()->dirs.size(), 1);
+        BOOST_CHECK_EQUAL(ap.corpus()->dirs[0], "a");
+        BOOST_REQUIRE(ap.corpus()->output_dir);
+        BOOST_CHECK_EQUAL(*ap.corpus()->output_dir, "out");
+        BOOST_CHECK_EQUAL(ap.log_level(), log::DEBUG);
+    }
+
+    BOOST_CHECK(!arg_dispatcher({"file.mal"}).corpus());
+
+    auto f = [](std::vector<std::string> args) {
+        try {
+            auto ap = arg_dispatcher(std::move(args));
+            BOOST_FAIL("Should have thrown");
+        } catch (system_exception& e) {
+            BOOST_CHECK_EQUAL(e.code().value(),
+                              static_cast<int>(std::errc::invalid_argument));
+        }
+    };
+
+    test::data_set(
+        f,
+        {
+            std::tuple{std::vector<std::string>{"--corpus"}},
+            std::tuple{std::vector<std::string>{"--corpus", "validate"}},
+            std::tuple{std::vector<std::string>{"--corpus", "foo", "a"}},
+            std::tuple{std::vector<std::string>{"--corpus", "normalise", "a"}},
+            std::tuple{std::vector<std::string>{"--corpus", "validate", "--output-dir"}},
+            std::tuple{std::vector<std::string>{"--output-dir", "out", "a"}},
+            std::tuple{std::vector<std::string>{"--corpus", "validate", "--string", "a", "b"}},
+            std::tuple{std::vector<std::string>{"--corpus", "validate", "--debugger-script", "a", "b"}},
+        }
+    );
+}
+
 BOOST_AUTO_TEST_CASE(program_source_streaming_operator)
 {
     auto f = [](auto source, auto expected) {
@@ -312,14 +363,18 @@ BOOST_AUTO_TEST_CASE(argument_parser_streaming_operator)
     const auto expected = "Malbolge virtual machine v"s + project_version +
         "\nUsage:"
         "\n\tmalbolge [options] <file>\n"
-        "\tcat <file> | malbolge [options]\n\n"
+        "\tcat <file> | malbolge [options]\n"
+        "\tmalbolge [options] --corpus <op> [--output-dir <dir>] <dir>...\n\n"
         "Options:\n"
         "\t-h --help\t\tDisplay this help message\n"
         "\t-v --version\t\tDisplay the full application version\n"
         "\t-l\t\t\tLog level, repeat the l character for higher logging levels\n"
         "\t--string\t\tPass a string argument as the program to run\n"
         "\t--debugger-script\tRun the given debugger script on the program\n"
-        "\t--force-non-normalised\tOverride normalised program detection to force to non-normalised";
+        "\t--force-non-normalised\tOverride normalised program detection to force to non-normalised\n"
+        "\t--corpus\t\tApply an operation (validate, normalise, or denormalise)\n"
+        "\t\t\tto every .mal file in the given directories, in parallel\n"
+        "\t--output-dir\t\tCorpus output directory, required to (de)normalise";
 
     auto ss = std::stringstream{};
     ss << arg_dispatcher({});
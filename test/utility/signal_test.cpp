@@ -7,6 +7,8 @@
 
 #include "test_helpers.hpp"
 
+#include <thread>
+
 using namespace malbolge;
 using namespace std::string_literals;
 
@@ -168,4 +170,72 @@ BOOST_AUTO_TEST_CASE(multiple_slot_disconnect)
     BOOST_CHECK_EQUAL(results[2], "hello");
 }
 
+BOOST_AUTO_TEST_CASE(reconnect_after_disconnect)
+{
+    auto count = 0;
+    auto slot = [&](auto) {
+        ++count;
+    };
+
+    auto sig = utility::signal<int>{};
+    sig(1);
+    BOOST_CHECK_EQUAL(count, 0);
+
+    auto conn = sig.connect(slot);
+    conn.disconnect();
+    sig(1);
+    BOOST_CHECK_EQUAL(count, 0);
+
+    sig.connect(slot);
+    sig(1);
+    BOOST_CHECK_EQUAL(count, 1);
+
+    auto copy = sig;
+    copy(1);
+    BOOST_CHECK_EQUAL(count, 2);
+}
+
+BOOST_AUTO_TEST_CASE(disconnect_from_slot)
+{
+    auto count = 0;
+    auto sig = utility::signal<int>{};
+    auto conn = utility::signal<int>::connection{};
+    conn = sig.connect([&](auto) {
+        ++count;
+        conn.disconnect();
+    });
+
+    sig(1);
+    sig(2);
+    BOOST_CHECK_EQUAL(count, 1);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_connect_and_fire)
+{
+    auto sig = utility::signal<int>{};
+    auto total = std::atomic<int>{0};
+    auto running = std::atomic<bool>{true};
+
+    // Always-connected slot, so we can check that firing never misses it
+    // whilst other slots are connected and disconnected around it
+    sig.connect([&](auto value) { total += value; });
+
+    auto firer = std::thread{[&]() {
+        for (auto i = 0; i < 10000; ++i) {
+            sig(1);
+        }
+        running = false;
+    }};
+
+    auto transient_count = std::atomic<int>{0};
+    while (running) {
+        auto conn = sig.connect([&](auto) { ++transient_count; });
+        conn.disconnect();
+    }
+    firer.join();
+
+    BOOST_CHECK_EQUAL(total, 10000);
+    BOOST_CHECK_LE(transient_count, 10000);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,131 @@
+/* Cam Mannett 2020
+ *
+ * See LICENSE file
+ */
+
+#include "malbolge/vcpu_snapshot.hpp"
+#include "malbolge/loader.hpp"
+#include "malbolge/utility/raii.hpp"
+
+#include "test_helpers.hpp"
+
+#include <sstream>
+
+using namespace malbolge;
+using namespace std::string_literals;
+
+namespace
+{
+vcpu_snapshot make_snapshot()
+{
+    auto snapshot = vcpu_snapshot{
+        load(std::filesystem::path{"programs/hello_world.mal"}),
+        math::ternary{42},
+        100,
+        math::ternary::max,
+        123456789,
+        {"Hello"s, ""s, "a\0b"s},
+        {{5, 0, true}, {math::ternary::max, 17, false}},
+        42
+    };
+
+    // Written cells in the middle of the fill region
+    snapshot.vmem[1000] = 7;
+    snapshot.vmem[1001] = 8;
+    snapshot.vmem[math::ternary::max] = 0;
+    return snapshot;
+}
+
+void check_equal(const vcpu_snapshot& lhs, const vcpu_snapshot& rhs)
+{
+    BOOST_CHECK_EQUAL(lhs.a, rhs.a);
+    BOOST_CHECK_EQUAL(lhs.c, rhs.c);
+    BOOST_CHECK_EQUAL(lhs.d, rhs.d);
+    BOOST_CHECK_EQUAL(lhs.p_counter, rhs.p_counter);
+    BOOST_CHECK_EQUAL(lhs.output_count, rhs.output_count);
+    BOOST_CHECK_EQUAL_COLLECTIONS(lhs.input.begin(), lhs.input.end(),
+                                  rhs.input.begin(), rhs.input.end());
+
+    BOOST_REQUIRE_EQUAL(lhs.breakpoints.size(), rhs.breakpoints.size());
+    for (auto i = 0u; i < lhs.breakpoints.size(); ++i) {
+        BOOST_CHECK_EQUAL(lhs.breakpoints[i].address, rhs.breakpoints[i].address);
+        BOOST_CHECK_EQUAL(lhs.breakpoints[i].ignore_count,
+                          rhs.breakpoints[i].ignore_count);
+        BOOST_CHECK_EQUAL(lhs.breakpoints[i].hit, rhs.breakpoints[i].hit);
+    }
+
+    for (auto i = 0u; i < lhs.vmem.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(lhs.vmem[i], rhs.vmem[i]);
+    }
+}
+}
+
+BOOST_AUTO_TEST_SUITE(vcpu_snapshot_suite)
+
+BOOST_AUTO_TEST_CASE(stream)
+{
+    const auto snapshot = make_snapshot();
+
+    auto stream = std::stringstream{};
+    save_snapshot(snapshot, stream);
+
+    // The fill region is stored as a bitmask, so the snapshot should be a
+    // fraction of the memory size
+    BOOST_CHECK_LT(stream.str().size(), 10 * 1024);
+
+    const auto loaded = load_snapshot(stream);
+    check_equal(loaded, snapshot);
+}
+
+BOOST_AUTO_TEST_CASE(file)
+{
+    const auto path = std::filesystem::temp_directory_path() /
+                      "malbolge_vcpu_snapshot_test.snap";
+    auto cleanup = utility::raii{[&]() { std::filesystem::remove(path); }};
+
+    const auto snapshot = make_snapshot();
+    save_snapshot(snapshot, path);
+    check_equal(load_snapshot(path), snapshot);
+
+    try {
+        [[maybe_unused]] auto s = load_snapshot(path.parent_path() / "missing.snap");
+        BOOST_FAIL("Should have thrown");
+    } catch (parse_exception&) {}
+}
+
+BOOST_AUTO_TEST_CASE(invalid)
+{
+    auto stream = std::stringstream{};
+    save_snapshot(make_snapshot(), stream);
+    const auto data = stream.str();
+
+    auto f = [](std::string data) {
+        auto in = std::istringstream{std::move(data)};
+        try {
+            [[maybe_unused]] auto s = load_snapshot(in);
+            BOOST_FAIL("Should have thrown");
+        } catch (parse_exception&) {}
+    };
+
+    auto with_byte = [&](std::size_t pos, char value) {
+        auto copy = data;
+        copy[pos] = value;
+        return copy;
+    };
+
+    test::data_set(
+        f,
+        {
+            std::tuple{""s},
+            std::tuple{data.substr(0, 8)},                          // Truncated version
+            std::tuple{data.substr(0, data.size() / 2)},            // Truncated memory
+            std::tuple{data.substr(0, data.size() - 1)},            // Truncated breakpoint
+            std::tuple{with_byte(0, 'X')},                          // Magic
+            std::tuple{with_byte(8, 1)},                            // Version
+            std::tuple{with_byte(13, '\xFF')},                      // A out of range
+            std::tuple{with_byte(34, '\x03')},                      // Fill first cells
+        }
+    );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -4,13 +4,19 @@
  */
 
 #include "malbolge/virtual_cpu.hpp"
+#include "malbolge/execute.hpp"
 #include "malbolge/loader.hpp"
+#include "malbolge/normalise.hpp"
 
 #include "test_helpers.hpp"
 
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
 #include <bitset>
 #include <condition_variable>
 #include <deque>
+#include <sstream>
 
 using namespace malbolge;
 using namespace std::string_literals;
@@ -89,6 +95,550 @@ BOOST_AUTO_TEST_CASE(state_streaming_operator)
     );
 }
 
+BOOST_AUTO_TEST_CASE(engine_streaming_operator)
+{
+    auto f = [](auto engine, auto expected) {
+        auto ss = std::stringstream{};
+        ss << engine;
+        BOOST_CHECK_EQUAL(ss.str(), expected);
+    };
+
+    test::data_set(
+        f,
+        {
+            std::tuple{virtual_cpu::engine_type::STANDARD,    "STANDARD"},
+            std::tuple{virtual_cpu::engine_type::THREADED,    "THREADED"},
+            std::tuple{virtual_cpu::engine_type::FUSED,       "FUSED"},
+            std::tuple{virtual_cpu::engine_type::NUM_ENGINES, "Unknown engine: 3"},
+        }
+    );
+}
+
+BOOST_AUTO_TEST_CASE(engines)
+{
+    struct run_result
+    {
+        std::string output;
+        std::vector<virtual_cpu::execution_state> states;
+        std::optional<std::size_t> error_step;
+        std::vector<math::ternary> registers;
+    };
+
+    auto f = [](auto make_vmem, auto input) {
+        auto run = [&](auto engine) {
+            auto ctx = boost::asio::io_context{};
+            auto result = run_result{};
+            {
+                auto vcpu = virtual_cpu{make_vmem(), ctx};
+                vcpu.set_engine(engine);
+                vcpu.register_for_state_signal([&](auto state, auto eptr) {
+                    result.states.push_back(state);
+                    if (eptr) {
+                        try {
+                            std::rethrow_exception(eptr);
+                        } catch (execution_exception& e) {
+                            result.error_step = e.step();
+                        }
+                    }
+                });
+                vcpu.register_for_output_signal([&](auto c) {
+                    result.output += c;
+                });
+
+                if (!input.empty()) {
+                    vcpu.add_input(input);
+                }
+                vcpu.run();
+                ctx.run();
+
+                for (auto reg : {virtual_cpu::vcpu_register::A,
+                                 virtual_cpu::vcpu_register::C,
+                                 virtual_cpu::vcpu_register::D}) {
+                    vcpu.register_value(reg, [&](auto, auto address, auto value) {
+                        if (address) {
+                            result.registers.push_back(*address);
+                        }
+                        result.registers.push_back(value);
+                    });
+                }
+                ctx.restart();
+                ctx.run();
+            }
+
+            return result;
+        };
+
+        const auto standard = run(virtual_cpu::engine_type::STANDARD);
+        BOOST_REQUIRE(!standard.states.empty());
+        BOOST_CHECK_EQUAL(standard.registers.size(), 5);
+
+        for (auto engine : {virtual_cpu::engine_type::THREADED,
+                            virtual_cpu::engine_type::FUSED}) {
+            BOOST_TEST_MESSAGE("Engine: " << engine);
+            const auto other = run(engine);
+
+            BOOST_CHECK_EQUAL(standard.output, other.output);
+            BOOST_CHECK_EQUAL_COLLECTIONS(standard.states.begin(), standard.states.end(),
+                                          other.states.begin(), other.states.end());
+            BOOST_CHECK(standard.error_step == other.error_step);
+            BOOST_CHECK_EQUAL_COLLECTIONS(standard.registers.begin(),
+                                          standard.registers.end(),
+                                          other.registers.begin(),
+                                          other.registers.end());
+        }
+    };
+
+    // Longer than a single run burst
+    auto long_program = []() {
+        constexpr auto pattern = std::string_view{"joo<jo<oo<j<o"};
+        auto program = std::string(math::ternary::max + 1, cpu_instruction::nop);
+        for (auto i = 0u; i < program.size(); ++i) {
+            program[i] = pattern[i % pattern.size()];
+        }
+        program.back() = cpu_instruction::stop;
+        return load(program, load_normalised_mode::ON);
+    };
+
+    test::data_set(
+        f,
+        {
+            std::tuple{std::function<virtual_memory ()>{[]() {
+                return load(std::filesystem::path{"programs/hello_world.mal"});
+            }}, ""s},
+            std::tuple{std::function<virtual_memory ()>{[]() {
+                return load(std::filesystem::path{"programs/echo.mal"});
+            }}, "Hello\nTest!\n"s},
+            std::tuple{std::function<virtual_memory ()>{[]() {
+                return load(std::filesystem::path{"programs/hello_world_normalised.mal"},
+                            load_normalised_mode::ON);
+            }}, ""s},
+            std::tuple{std::function<virtual_memory ()>{long_program}, ""s},
+            std::tuple{std::function<virtual_memory ()>{[&]() {
+                return long_program().clone();
+            }}, ""s},
+            std::tuple{std::function<virtual_memory ()>{[]() {
+                return load(std::filesystem::path{"programs/echo.mal"}).clone();
+            }}, "Hello\nTest!\n"s},
+            std::tuple{std::function<virtual_memory ()>{[]() {
+                return virtual_memory(std::vector<int>{0, 0});
+            }}, ""s},
+        }
+    );
+}
+
+BOOST_AUTO_TEST_CASE(snapshot_restore)
+{
+    struct run_result
+    {
+        std::string output;
+        std::size_t bp_hits = 0;
+        virtual_cpu::execution_state state = virtual_cpu::execution_state::READY;
+    };
+
+    auto attach = [](virtual_cpu& vcpu, run_result& result) {
+        vcpu.register_for_state_signal([&](auto state, auto eptr) {
+            BOOST_CHECK(!eptr);
+            result.state = state;
+        });
+        vcpu.register_for_output_signal([&](auto c) {
+            result.output += c;
+        });
+        vcpu.register_for_breakpoint_hit_signal([&](auto) {
+            ++result.bp_hits;
+        });
+    };
+
+    auto ctx = boost::asio::io_context{};
+    auto process = [&]() {
+        ctx.restart();
+        ctx.run();
+    };
+
+    // Runs until the program needs more input, resuming after each breakpoint
+    auto run_to_end = [&](virtual_cpu& vcpu, run_result& result) {
+        while (result.state != virtual_cpu::execution_state::WAITING_FOR_INPUT) {
+            BOOST_REQUIRE(result.state != virtual_cpu::execution_state::STOPPED);
+            vcpu.run();
+            process();
+        }
+    };
+
+    auto take_snapshot = [&](virtual_cpu& vcpu) {
+        auto snapshot = std::optional<vcpu_snapshot>{};
+        vcpu.snapshot([&](auto s) { snapshot = std::move(s); });
+        process();
+        BOOST_REQUIRE(snapshot);
+        return std::move(*snapshot);
+    };
+
+    auto check_registers = [](const vcpu_snapshot& lhs, const vcpu_snapshot& rhs) {
+        BOOST_CHECK_EQUAL(lhs.a, rhs.a);
+        BOOST_CHECK_EQUAL(lhs.c, rhs.c);
+        BOOST_CHECK_EQUAL(lhs.d, rhs.d);
+        BOOST_CHECK_EQUAL(lhs.p_counter, rhs.p_counter);
+    };
+
+    auto result = run_result{};
+    auto vcpu = virtual_cpu{load(std::filesystem::path{"programs/echo.mal"}), ctx};
+    attach(vcpu, result);
+    vcpu.add_input("Hello\n"s);
+    vcpu.add_input("Test!\n"s);
+    vcpu.add_breakpoint(37, 3);
+    vcpu.run();
+    process();
+    BOOST_REQUIRE_EQUAL(result.state, virtual_cpu::execution_state::PAUSED);
+    BOOST_REQUIRE_EQUAL(result.bp_hits, 1);
+
+    auto stream = std::stringstream{};
+    {
+        const auto snapshot = take_snapshot(vcpu);
+        BOOST_CHECK_EQUAL(snapshot.c, 37);
+        BOOST_REQUIRE_EQUAL(snapshot.input.size(), 2);
+        BOOST_CHECK_LT(snapshot.input[0].size(), 6);
+        BOOST_CHECK_EQUAL(snapshot.input[1], "Test!\n");
+        BOOST_REQUIRE_EQUAL(snapshot.breakpoints.size(), 1);
+        BOOST_CHECK_EQUAL(snapshot.breakpoints[0].address, 37);
+        BOOST_CHECK_EQUAL(snapshot.breakpoints[0].ignore_count, 0);
+        BOOST_CHECK(snapshot.breakpoints[0].hit);
+
+        save_snapshot(snapshot, stream);
+    }
+    const auto data = stream.str();
+
+    const auto prefix = result.output;
+    result = run_result{"", 0, result.state};
+    run_to_end(vcpu, result);
+    const auto expected = result;
+    const auto expected_snapshot = take_snapshot(vcpu);
+    BOOST_CHECK_EQUAL(prefix + expected.output, "Hello\nTest!\n");
+    BOOST_CHECK_GT(expected.bp_hits, 0);
+
+    BOOST_TEST_MESSAGE("Snapshot constructor");
+    // Outlives the vCPU, as its final state signal is fired from ctx
+    auto restored_result = run_result{};
+    {
+        auto in = std::istringstream{data};
+        auto restored = virtual_cpu{load_snapshot(in), ctx};
+        attach(restored, restored_result);
+        run_to_end(restored, restored_result);
+
+        BOOST_CHECK_EQUAL(restored_result.output, expected.output);
+        BOOST_CHECK_EQUAL(restored_result.bp_hits, expected.bp_hits);
+        check_registers(take_snapshot(restored), expected_snapshot);
+    }
+
+    BOOST_TEST_MESSAGE("Restore");
+    {
+        auto in = std::istringstream{data};
+        result = run_result{"", 0, result.state};
+        vcpu.restore(load_snapshot(in));
+        process();
+        run_to_end(vcpu, result);
+
+        BOOST_CHECK_EQUAL(result.output, expected.output);
+        BOOST_CHECK_EQUAL(result.bp_hits, expected.bp_hits);
+        check_registers(take_snapshot(vcpu), expected_snapshot);
+    }
+
+    BOOST_TEST_MESSAGE("Null in restored input");
+    {
+        auto fresh = virtual_cpu{load(std::filesystem::path{"programs/echo.mal"}),
+                                 ctx};
+        auto snapshot = take_snapshot(fresh);
+        snapshot.input = {"a\0b"s};
+
+        auto null_stream = std::stringstream{};
+        save_snapshot(snapshot, null_stream);
+
+        result = run_result{};
+        vcpu.restore(load_snapshot(null_stream));
+        process();
+        run_to_end(vcpu, result);
+
+        BOOST_CHECK_EQUAL(result.output, "a");
+        BOOST_CHECK(take_snapshot(vcpu).input.empty());
+    }
+
+    BOOST_TEST_MESSAGE("Invalid snapshot");
+    {
+        auto fresh = virtual_cpu{load(std::filesystem::path{"programs/echo.mal"}),
+                                 ctx};
+        const auto valid = take_snapshot(fresh);
+
+        auto f = [&](auto&& modify) {
+            auto make_snapshot = [&]() {
+                auto snapshot = take_snapshot(fresh);
+                modify(snapshot);
+                return snapshot;
+            };
+
+            BOOST_CHECK_THROW(virtual_cpu(make_snapshot(), ctx),
+                              execution_exception);
+            BOOST_CHECK_THROW(virtual_cpu{make_snapshot()}, execution_exception);
+            BOOST_CHECK_THROW(fresh.restore(make_snapshot()), execution_exception);
+        };
+
+        f([](auto& s) { s.c = math::ternary::max + 1u; });
+        f([](auto& s) { s.d = math::ternary::max + 1u; });
+        f([](auto& s) { s.breakpoints = {{4, 0, false}, {4, 1, false}}; });
+
+        // Nothing was posted, so the vCPU is unaffected
+        process();
+        check_registers(take_snapshot(fresh), valid);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(limits)
+{
+    struct run_result
+    {
+        std::string output;
+        virtual_cpu::execution_state state = virtual_cpu::execution_state::READY;
+        std::optional<limit_exception::limit_type> limit;
+        std::size_t limit_step = 0;
+    };
+
+    const auto echo_input = std::string(3000, 'a');
+
+    auto ctx = boost::asio::io_context{};
+    auto process = [&]() {
+        ctx.restart();
+        ctx.run();
+    };
+
+    auto run = [&](const std::filesystem::path& program,
+                   virtual_cpu::engine_type engine,
+                   execution_limits limits,
+                   std::string_view input) {
+        auto result = run_result{};
+        {
+            auto vcpu = virtual_cpu{load(program), ctx};
+            vcpu.register_for_state_signal([&](auto state, auto eptr) {
+                result.state = state;
+                if (!eptr) {
+                    return;
+                }
+
+                try {
+                    std::rethrow_exception(eptr);
+                } catch (limit_exception& e) {
+                    result.limit = e.type();
+                    result.limit_step = e.step();
+                } catch (std::exception& e) {
+                    BOOST_TEST_MESSAGE(e.what());
+                    BOOST_CHECK_MESSAGE(false, "Unexpected error signal");
+                }
+            });
+            vcpu.register_for_output_signal([&](auto c) {
+                result.output += c;
+            });
+
+            vcpu.set_engine(engine);
+            vcpu.set_limits(std::move(limits));
+            if (!input.empty()) {
+                vcpu.add_input(std::string{input});
+            }
+            vcpu.run();
+            process();
+        }
+
+        // Process the final state signal
+        process();
+        return result;
+    };
+
+    auto reference = [&](malbolge::execution_limits limits) {
+        auto output = ""s;
+        const auto result = execute(load(std::filesystem::path{"programs/echo.mal"}),
+                                    echo_input,
+                                    output,
+                                    limits);
+        return std::pair{result, output};
+    };
+
+    const auto [full, full_output] = reference({});
+    BOOST_REQUIRE_GT(full.steps, 3 * 4096);
+    BOOST_REQUIRE_GT(full_output.size(), 1000);
+
+    for (auto engine : {virtual_cpu::engine_type::STANDARD,
+                        virtual_cpu::engine_type::THREADED,
+                        virtual_cpu::engine_type::FUSED}) {
+        BOOST_TEST_MESSAGE("Engine: " << engine);
+
+        // Instruction limit, spanning multiple run bursts
+        {
+            auto limits = execution_limits{};
+            limits.max_steps = full.steps / 2 + 1;
+            const auto [expected, expected_output] = reference({limits.max_steps});
+            BOOST_REQUIRE_EQUAL(expected.state, execution_result::status::LIMIT_REACHED);
+            BOOST_REQUIRE_EQUAL(*expected.limit, execution_limits::limit_type::STEPS);
+
+            const auto result = run("programs/echo.mal", engine, limits, echo_input);
+            BOOST_CHECK_EQUAL(result.state, virtual_cpu::execution_state::STOPPED);
+            BOOST_REQUIRE(result.limit);
+            BOOST_CHECK_EQUAL(*result.limit, limit_exception::limit_type::STEPS);
+            BOOST_CHECK_EQUAL(result.limit_step, limits.max_steps);
+            BOOST_CHECK_EQUAL(result.output, expected_output);
+        }
+
+        // Output limit
+        {
+            auto limits = execution_limits{};
+            limits.max_output = 1000;
+            const auto [expected, expected_output] =
+                reference({std::numeric_limits<std::size_t>::max(), limits.max_output});
+            BOOST_REQUIRE_EQUAL(expected.state, execution_result::status::LIMIT_REACHED);
+            BOOST_REQUIRE_EQUAL(*expected.limit, execution_limits::limit_type::OUTPUT);
+
+            const auto result = run("programs/echo.mal", engine, limits, echo_input);
+            BOOST_CHECK_EQUAL(result.state, virtual_cpu::execution_state::STOPPED);
+            BOOST_REQUIRE(result.limit);
+            BOOST_CHECK_EQUAL(*result.limit, limit_exception::limit_type::OUTPUT);
+            BOOST_CHECK_EQUAL(result.limit_step, expected.steps);
+            BOOST_CHECK_EQUAL(result.output, expected_output);
+        }
+
+        // Deadline whilst waiting for input
+        {
+            auto limits = execution_limits{};
+            limits.deadline = std::chrono::steady_clock::now() + 20ms;
+
+            const auto result = run("programs/echo.mal", engine, limits, "");
+            BOOST_CHECK_EQUAL(result.state, virtual_cpu::execution_state::STOPPED);
+            BOOST_REQUIRE(result.limit);
+            BOOST_CHECK_EQUAL(*result.limit, limit_exception::limit_type::DEADLINE);
+            BOOST_CHECK(std::chrono::steady_clock::now() >= *limits.deadline);
+        }
+
+        // Limits that are not reached, a pending deadline must not keep the
+        // event loop running once the program has stopped
+        {
+            auto limits = execution_limits{};
+            limits.max_steps = 10'000;
+            limits.max_output = 12;
+            limits.deadline = std::chrono::steady_clock::now() + 1h;
+
+            const auto result = run("programs/hello_world.mal", engine, limits, "");
+            BOOST_CHECK_EQUAL(result.state, virtual_cpu::execution_state::STOPPED);
+            BOOST_CHECK(!result.limit);
+            BOOST_CHECK_EQUAL(result.output, "Hello World!");
+            BOOST_CHECK(std::chrono::steady_clock::now() < *limits.deadline);
+        }
+    }
+
+    BOOST_TEST_MESSAGE("Step");
+    {
+        auto state = virtual_cpu::execution_state::READY;
+        auto limit = std::optional<limit_exception::limit_type>{};
+        {
+            auto vcpu = virtual_cpu{load(std::filesystem::path{"programs/hello_world.mal"}),
+                                    ctx};
+            vcpu.register_for_state_signal([&](auto s, auto eptr) {
+                state = s;
+                if (eptr) {
+                    try {
+                        std::rethrow_exception(eptr);
+                    } catch (limit_exception& e) {
+                        limit = e.type();
+                    }
+                }
+            });
+
+            auto limits = execution_limits{};
+            limits.max_steps = 2;
+            vcpu.set_limits(std::move(limits));
+
+            vcpu.step();
+            vcpu.step();
+            process();
+            BOOST_CHECK_EQUAL(state, virtual_cpu::execution_state::PAUSED);
+            BOOST_CHECK(!limit);
+
+            vcpu.step();
+            process();
+            BOOST_CHECK_EQUAL(state, virtual_cpu::execution_state::STOPPED);
+            BOOST_REQUIRE(limit);
+            BOOST_CHECK_EQUAL(*limit, limit_exception::limit_type::STEPS);
+        }
+        process();
+    }
+
+    BOOST_TEST_MESSAGE("Restore output count");
+    {
+        auto state = virtual_cpu::execution_state::READY;
+        auto output = ""s;
+        {
+            auto vcpu = virtual_cpu{load(std::filesystem::path{"programs/echo.mal"}),
+                                    ctx};
+            vcpu.register_for_state_signal([&](auto s, auto eptr) {
+                BOOST_CHECK(!eptr);
+                state = s;
+            });
+            vcpu.register_for_output_signal([&](auto c) {
+                output += c;
+            });
+
+            auto limits = execution_limits{};
+            limits.max_output = 5;
+            vcpu.set_limits(std::move(limits));
+
+            auto snapshot = std::optional<vcpu_snapshot>{};
+            vcpu.snapshot([&](auto s) { snapshot = std::move(s); });
+            vcpu.add_input("abc"s);
+            vcpu.run();
+            process();
+            BOOST_CHECK_EQUAL(state, virtual_cpu::execution_state::WAITING_FOR_INPUT);
+            BOOST_CHECK_EQUAL(output, "abc");
+            BOOST_REQUIRE(snapshot);
+            BOOST_CHECK_EQUAL(snapshot->output_count, 0);
+
+            vcpu.snapshot([&](auto s) {
+                BOOST_CHECK_EQUAL(s.output_count, 3);
+            });
+
+            // The output count is rewound with the rest of the state, so all of
+            // this input is within the limit
+            output.clear();
+            vcpu.restore(std::move(*snapshot));
+            vcpu.add_input("defgh"s);
+            process();
+            BOOST_CHECK_EQUAL(state, virtual_cpu::execution_state::WAITING_FOR_INPUT);
+            BOOST_CHECK_EQUAL(output, "defgh");
+        }
+        process();
+    }
+
+    BOOST_TEST_MESSAGE("Owned event loop");
+    {
+        auto mtx = std::mutex{};
+        auto cv = std::condition_variable{};
+        auto limit = std::optional<limit_exception::limit_type>{};
+        auto stopped = false;
+
+        auto vcpu = virtual_cpu{load(std::filesystem::path{"programs/echo.mal"})};
+        vcpu.register_for_state_signal([&](auto state, auto eptr) {
+            if (eptr) {
+                try {
+                    std::rethrow_exception(eptr);
+                } catch (limit_exception& e) {
+                    limit = e.type();
+                }
+            }
+            check_state(state, virtual_cpu::execution_state::STOPPED, mtx, cv, stopped);
+        });
+
+        auto limits = execution_limits{};
+        limits.deadline = std::chrono::steady_clock::now() + 20ms;
+        vcpu.set_limits(std::move(limits));
+        vcpu.run();
+
+        auto lk = std::unique_lock{mtx};
+        BOOST_REQUIRE(cv.wait_for(lk, 1s, [&]() { return stopped; }));
+        BOOST_REQUIRE(limit);
+        BOOST_CHECK_EQUAL(*limit, limit_exception::limit_type::DEADLINE);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(move_from)
 {
     auto vmem = load(std::filesystem::path{"programs/hello_world.mal"});
@@ -364,6 +914,144 @@ BOOST_AUTO_TEST_CASE(echo)
     BOOST_CHECK(expected_states.empty());
 }
 
+BOOST_AUTO_TEST_CASE(external_event_loop)
+{
+    auto ctx = boost::asio::io_context{};
+    auto work_guard = boost::asio::make_work_guard(ctx);
+    auto threads = std::vector<std::thread>{};
+    for (auto i = 0u; i < 3; ++i) {
+        threads.emplace_back([&]() { ctx.run(); });
+    }
+
+    constexpr auto num_vcpus = 20u;
+    auto mtx = std::mutex{};
+    auto cv = std::condition_variable{};
+    auto stopped = 0u;
+    auto outputs = std::vector<std::string>(num_vcpus);
+    auto errors = 0u;
+
+    {
+        auto vcpus = std::vector<virtual_cpu>{};
+        for (auto i = 0u; i < num_vcpus; ++i) {
+            // Make the last one invalid, its exception must not escape ctx
+            auto vmem = i == (num_vcpus - 1) ?
+                virtual_memory(std::vector<int>{0, 0}) :
+                load(std::filesystem::path{"programs/hello_world.mal"});
+
+            auto& vcpu = vcpus.emplace_back(std::move(vmem), ctx);
+            vcpu.register_for_state_signal([&](auto state, auto eptr) {
+                if (state == virtual_cpu::execution_state::STOPPED) {
+                    {
+                        auto lk = std::lock_guard{mtx};
+                        ++stopped;
+                        errors += !!eptr;
+                    }
+                    cv.notify_one();
+                }
+            });
+            vcpu.register_for_output_signal([&outputs, i](auto c) {
+                outputs[i] += c;
+            });
+            vcpu.run();
+        }
+
+        auto lk = std::unique_lock{mtx};
+        BOOST_CHECK(cv.wait_for(lk, 1s, [&]() { return stopped == num_vcpus; }));
+        BOOST_CHECK_EQUAL(errors, 1);
+    }
+
+    for (auto i = 0u; i < (num_vcpus - 1); ++i) {
+        BOOST_CHECK_EQUAL(outputs[i], "Hello World!");
+    }
+
+    work_guard.reset();
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+BOOST_AUTO_TEST_CASE(external_event_loop_destruction)
+{
+    auto ctx = boost::asio::io_context{};
+    auto stopped = false;
+
+    {
+        auto vmem = load(std::filesystem::path{"programs/echo.mal"});
+        auto vcpu = virtual_cpu{std::move(vmem), ctx};
+        vcpu.register_for_state_signal([&](auto state, auto eptr) {
+            BOOST_CHECK(!eptr);
+            stopped = state == virtual_cpu::execution_state::STOPPED;
+        });
+        vcpu.run();
+        ctx.poll();
+        BOOST_CHECK(!stopped);
+
+        // This will be discarded on destruction
+        vcpu.add_input("Hello\n");
+    }
+
+    BOOST_CHECK(!stopped);
+    ctx.restart();
+    ctx.poll();
+    BOOST_CHECK(stopped);
+}
+
+BOOST_AUTO_TEST_CASE(buffered_output)
+{
+    auto vmem = load(std::filesystem::path{"programs/echo.mal"});
+    auto vcpu = virtual_cpu{std::move(vmem)};
+    auto mtx = std::mutex{};
+    auto cv = std::condition_variable{};
+    auto waiting = 0u;
+
+    // Record the buffered output and state changes together, to check that
+    // output is flushed before the state change
+    auto events = std::vector<std::string>{};
+    auto char_output = ""s;
+
+    vcpu.register_for_state_signal([&](auto state, auto eptr) {
+        BOOST_CHECK(!eptr);
+        if (state == virtual_cpu::execution_state::WAITING_FOR_INPUT) {
+            {
+                auto lk = std::lock_guard{mtx};
+                events.push_back("WAITING");
+                ++waiting;
+            }
+            cv.notify_one();
+        }
+    });
+    vcpu.register_for_buffered_output_signal([&](auto str) {
+        BOOST_CHECK(!str.empty());
+        auto lk = std::lock_guard{mtx};
+        events.emplace_back(str);
+    });
+    vcpu.register_for_output_signal([&](auto c) {
+        auto lk = std::lock_guard{mtx};
+        char_output += c;
+    });
+
+    vcpu.add_input("Hello\n");
+    vcpu.run();
+    {
+        auto lk = std::unique_lock{mtx};
+        BOOST_REQUIRE(cv.wait_for(lk, 100ms, [&]() { return waiting == 1; }));
+    }
+
+    vcpu.add_input("World!\n");
+    {
+        auto lk = std::unique_lock{mtx};
+        BOOST_REQUIRE(cv.wait_for(lk, 100ms, [&]() { return waiting == 2; }));
+    }
+
+    auto lk = std::lock_guard{mtx};
+    const auto expected = std::vector<std::string>{
+        "Hello\n", "WAITING", "World!\n", "WAITING"
+    };
+    BOOST_CHECK_EQUAL_COLLECTIONS(events.begin(), events.end(),
+                                  expected.begin(), expected.end());
+    BOOST_CHECK_EQUAL(char_output, "Hello\nWorld!\n");
+}
+
 BOOST_AUTO_TEST_CASE(invalid_register_value_query)
 {
     auto vmem = load(std::filesystem::path{"programs/hello_world.mal"});
@@ -7,6 +7,9 @@
 
 #include "test_helpers.hpp"
 
+#include <random>
+#include <utility>
+
 using namespace malbolge;
 
 BOOST_AUTO_TEST_SUITE(virtual_memory_suite)
@@ -58,6 +61,134 @@ BOOST_AUTO_TEST_CASE(constructor)
     }
 }
 
+BOOST_AUTO_TEST_CASE(in_place_constructor)
+{
+    const auto program = std::vector<int>{0, 3, 5, 6, 7, 1};
+    auto writer = [&](auto first, auto last) {
+        BOOST_REQUIRE_EQUAL(static_cast<std::size_t>(last - first),
+                            math::ternary::max + 1u);
+        std::copy(program.begin(), program.end(), first);
+        return program.size();
+    };
+
+    const auto vmem = virtual_memory(std::in_place, writer);
+    const auto expected = virtual_memory(program);
+    for (auto i = 0u; i < vmem.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(vmem[i], expected[i]);
+    }
+
+    BOOST_TEST_MESSAGE("Invalid lengths");
+    auto f = [](auto length) {
+        try {
+            auto vmem = virtual_memory(std::in_place, [&](auto, auto) {
+                return length;
+            });
+            BOOST_FAIL("Should have thrown");
+        } catch (parse_exception&) {}
+    };
+
+    test::data_set(
+        f,
+        {
+            std::tuple{std::size_t{0}},
+            std::tuple{std::size_t{1}},
+            std::tuple{std::size_t{math::ternary::max + 2}},
+        }
+    );
+}
+
+BOOST_AUTO_TEST_CASE(fill)
+{
+    // The memory fill takes a shortcut once the op cycle is detected, so
+    // check it against the basic recurrence for a range of program lengths and
+    // values (including non-graphical ones)
+    auto gen = std::mt19937{42};
+    auto dist = std::uniform_int_distribution<math::ternary::underlying_type>{
+        0,
+        math::ternary::max
+    };
+
+    for (auto length : {2u, 3u, 7u, 100u, math::ternary::max - 3, math::ternary::max}) {
+        for (auto trial = 0u; trial < 20; ++trial) {
+            auto program = std::vector<math::ternary>(length);
+            for (auto& cell : program) {
+                cell = trial < 10 ? dist(gen) : 33 + (dist(gen) % 94);
+            }
+
+            const auto vmem = virtual_memory(program);
+            for (auto i = 0u; i < length; ++i) {
+                BOOST_REQUIRE_EQUAL(vmem[i], program[i]);
+            }
+            for (auto i = length; i < vmem.size(); ++i) {
+                BOOST_REQUIRE_EQUAL(vmem[i], vmem[i-1].op(vmem[i-2]));
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(clone)
+{
+    const auto num_pages = math::ternary::max / virtual_memory::page_size + 1;
+    const auto program = std::vector<int>{0, 3, 5, 6, 7, 1};
+    const auto expected = virtual_memory(program);
+
+    auto vmem = virtual_memory(program);
+    BOOST_CHECK(vmem.flat_data());
+    BOOST_CHECK_EQUAL(vmem.num_private_pages(), num_pages);
+
+    auto clone = vmem.clone();
+    BOOST_CHECK(!vmem.flat_data());
+    BOOST_CHECK(!clone.flat_data());
+    BOOST_CHECK_EQUAL(vmem.num_private_pages(), 0);
+    BOOST_CHECK_EQUAL(clone.num_private_pages(), 0);
+    for (auto i = 0u; i < vmem.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(std::as_const(clone)[i], expected[i]);
+    }
+
+    BOOST_TEST_MESSAGE("Reads do not copy");
+    for (auto i = 0u; i < vmem.size(); ++i) {
+        BOOST_REQUIRE_EQUAL(std::as_const(vmem).unchecked_at(i), expected[i]);
+    }
+    BOOST_CHECK_EQUAL(vmem.num_private_pages(), 0);
+
+    BOOST_TEST_MESSAGE("Writes are isolated");
+    clone[5] = 42;
+    clone[virtual_memory::page_size] = 43;
+    vmem[math::ternary::max] = 44;
+    BOOST_CHECK_EQUAL(clone.num_private_pages(), 2);
+    BOOST_CHECK_EQUAL(vmem.num_private_pages(), 1);
+
+    for (auto i = 0u; i < vmem.size(); ++i) {
+        const auto clone_value = i == 5 ? math::ternary{42} :
+                                 i == virtual_memory::page_size ? math::ternary{43} :
+                                 expected[i];
+        const auto vmem_value = i == math::ternary::max ? math::ternary{44} :
+                                expected[i];
+        BOOST_REQUIRE_EQUAL(std::as_const(clone)[i], clone_value);
+        BOOST_REQUIRE_EQUAL(std::as_const(vmem)[i], vmem_value);
+    }
+
+    BOOST_TEST_MESSAGE("Clone of a clone");
+    auto clone2 = clone.clone();
+    BOOST_CHECK_EQUAL(clone.num_private_pages(), 2);
+    BOOST_CHECK_EQUAL(clone2.num_private_pages(), 2);
+    BOOST_CHECK_EQUAL(clone2[5], 42);
+    BOOST_CHECK_EQUAL(clone2[virtual_memory::page_size], 43);
+    BOOST_CHECK_EQUAL(clone2[math::ternary::max], expected[math::ternary::max]);
+
+    clone2[5] = 1;
+    BOOST_CHECK_EQUAL(clone[5], 42);
+
+    BOOST_TEST_MESSAGE("Outlives the original");
+    {
+        auto tmp = std::move(vmem);
+    }
+    auto it = clone.cbegin() + 6;
+    for (auto i = 6u; i < virtual_memory::page_size; ++i, ++it) {
+        BOOST_REQUIRE_EQUAL(*it, expected[i]);
+    }
+}
+
 BOOST_AUTO_TEST_CASE(constants)
 {
     auto vmem = virtual_memory(std::vector<int>{0, 3, 5, 6, 7, 1});
@@ -66,6 +197,52 @@ BOOST_AUTO_TEST_CASE(constants)
     BOOST_CHECK_EQUAL(vmem.size(), vmem.max_size());
 }
 
+BOOST_AUTO_TEST_CASE(element_access)
+{
+    auto vmem = virtual_memory(std::vector<int>{0, 3, 5, 6, 7, 1});
+    const auto& cvmem = vmem;
+
+    auto f = [&](auto pos, auto expected_pos) {
+        const auto& expected = *(vmem.begin() + expected_pos);
+
+        BOOST_CHECK_EQUAL(&vmem[pos], &expected);
+        BOOST_CHECK_EQUAL(&cvmem[pos], &expected);
+        BOOST_CHECK_EQUAL(&vmem.at(pos), &expected);
+        BOOST_CHECK_EQUAL(&cvmem.at(pos), &expected);
+    };
+
+    test::data_set(
+        f,
+        {
+            std::tuple{std::size_t{0},                    std::size_t{0}},
+            std::tuple{std::size_t{4},                    std::size_t{4}},
+            std::tuple{std::size_t{math::ternary::max},   std::size_t{math::ternary::max}},
+            std::tuple{std::size_t{math::ternary::max+1}, std::size_t{0}},
+            std::tuple{std::size_t{math::ternary::max+5}, std::size_t{4}},
+        }
+    );
+
+    auto g = [&](math::ternary pos) {
+        const auto& expected = *(vmem.begin() + static_cast<std::size_t>(pos));
+
+        BOOST_CHECK_EQUAL(&vmem[pos], &expected);
+        BOOST_CHECK_EQUAL(&cvmem[pos], &expected);
+        BOOST_CHECK_EQUAL(&vmem.at(pos), &expected);
+        BOOST_CHECK_EQUAL(&cvmem.at(pos), &expected);
+        BOOST_CHECK_EQUAL(&vmem.unchecked_at(static_cast<std::size_t>(pos)), &expected);
+        BOOST_CHECK_EQUAL(&cvmem.unchecked_at(static_cast<std::size_t>(pos)), &expected);
+    };
+
+    test::data_set(
+        g,
+        {
+            std::tuple{math::ternary{0}},
+            std::tuple{math::ternary{4}},
+            std::tuple{math::ternary{math::ternary::max}},
+        }
+    );
+}
+
 BOOST_AUTO_TEST_CASE(iterator_arithmetic)
 {
     auto vmem = virtual_memory(std::vector<int>{0, 3, 5, 6, 7, 1});